@@ -3,8 +3,75 @@
 #include "distance.hpp"
 #include "intersection.hpp"
 
+#include <algorithm>
 #include <vector>
 
+namespace {
+
+// Straight-line versions of the point collisions for the packet lanes. They
+// compute the same quantities as the functions below without going through
+// Line, so that nothing in a lane loop branches on the lane's data.
+struct LaneCollision {
+    Collision collision;
+    bool hit = false;
+};
+
+// collide(point, movement, segment) for the segment start + edge * u.
+LaneCollision laneCollide(
+    const Point& point,
+    const Vector& movement,
+    const Point& start,
+    const Vector& edge,
+    const Norm& norm)
+{
+    Vector toStart = start - point;
+    Scalar denominator = cross(movement, edge);
+    bool parallel = denominator == 0;
+    Scalar divisor = parallel ? Scalar{1} : denominator;
+    Scalar t = cross(toStart, edge) / divisor;
+    Scalar u = cross(toStart, movement) / divisor;
+    bool hit = !parallel & (t >= 0) & (u >= 0) & (u <= 1);
+
+    return LaneCollision{
+        .collision = Collision{
+            .position = point + movement * t,
+            .movement = mirror(movement, norm),
+        },
+        .hit = hit,
+    };
+}
+
+// collide(point, movement, Circle{center, radius})
+LaneCollision laneCollide(
+    const Point& point, const Vector& movement, const Point& center, Scalar radius)
+{
+    Scalar squareMovement = movement.squareLength();
+    Scalar divisor = squareMovement == 0 ? Scalar{1} : squareMovement;
+    Point closestToCenter = point + movement * (dot(center - point, movement) / divisor);
+
+    Scalar squareRadius = radius * radius;
+    Scalar sq = squareDistance(closestToCenter, center);
+    bool hit = (squareMovement > 0) & (sq < squareRadius);
+    using std::sqrt;
+    Scalar missingDistance = sqrt(std::max(squareRadius - sq, Scalar{0}));
+
+    Vector shiftDirection = point - closestToCenter;
+    shiftDirection.normalize();
+    Point collisionPoint = closestToCenter + shiftDirection * missingDistance;
+    Vector normal = collisionPoint - center;
+    normal.normalize();
+
+    return LaneCollision{
+        .collision = Collision{
+            .position = collisionPoint,
+            .movement = mirror(movement, Norm::fromUnit(normal)),
+        },
+        .hit = hit,
+    };
+}
+
+} // namespace
+
 std::optional<Collision> collide(const Point& point, const Vector& movement, const Line& line)
 {
     auto intersection = intersectionPoint(Line{point, movement}, line);
@@ -23,13 +90,14 @@ std::optional<Collision> collide(const Point& point, const Vector& movement, con
     auto movementLine = Line{point, movement};
     Point closestToCenter = closestPoint(movementLine, circle.center);
 
-    float sq = squareDistance(closestToCenter, circle.center);
+    Scalar sq = squareDistance(closestToCenter, circle.center);
     if (sq >= circle.radius * circle.radius) {
         return std::nullopt;
     }
 
-    float d = std::sqrt(sq);
-    float missingDistance = std::sqrt(circle.radius * circle.radius - d * d);
+    using std::sqrt;
+    Scalar d = sqrt(sq);
+    Scalar missingDistance = sqrt(circle.radius * circle.radius - d * d);
     Norm shiftDirection = (point - closestToCenter).normalized();
     Point collisionPoint = closestToCenter + shiftDirection * missingDistance;
 
@@ -72,7 +140,6 @@ std::optional<Collision> collide(const Circle& circle, const Vector& movement, c
     auto firstCircle = Circle{segment.start(), circle.radius};
     auto secondCircle = Circle{segment.end(), circle.radius};
 
-    auto movementRay = Ray{circle.center, movement};
     return bestCollision(
         circle.center,
         std::array{
@@ -91,4 +158,56 @@ std::optional<Collision> collide(
         collisions.push_back(collide(circle, movement, segment));
     }
     return bestCollision(circle.center, collisions);
-}
\ No newline at end of file
+}
+
+// Every lane tests the three candidates of the scalar version (the segment
+// moved towards the circle, then the circles at both ends) and keeps the
+// closest hit.
+template <size_t N>
+CollisionPacket<N> collide(
+    const CirclePacket<N>& circles,
+    const VectorPacket<N>& movements,
+    const Segment& segment)
+{
+    Point start = segment.start();
+    Point end = segment.end();
+    Vector edge = end - start;
+    const Norm& norm = segment.norm();
+    Scalar value = segment.line().value();
+
+    auto result = CollisionPacket<N>{};
+    for (size_t i = 0; i < N; i++) {
+        Point center = circles.center[i];
+        Scalar radius = circles.radius[i];
+        Vector movement = movements[i];
+
+        // Segment::movedTowards(center, radius)
+        Scalar shift = dot(norm, center.asVector()) >= value ? radius : -radius;
+        Vector offset = static_cast<const Vector&>(norm) * shift;
+
+        const LaneCollision candidates[] = {
+            laneCollide(center, movement, start + offset, edge, norm),
+            laneCollide(center, movement, start, radius),
+            laneCollide(center, movement, end, radius),
+        };
+
+        LaneCollision best;
+        Scalar bestDistance = std::numeric_limits<Scalar>::infinity();
+        for (const LaneCollision& candidate : candidates) {
+            Scalar d = squareDistance(center, candidate.collision.position);
+            bool better = candidate.hit & (d < bestDistance);
+            best = better ? candidate : best;
+            bestDistance = better ? d : bestDistance;
+        }
+
+        result.position.set(i, best.collision.position);
+        result.movement.set(i, best.collision.movement);
+        result.mask |= HitMask{best.hit} << i;
+    }
+    return result;
+}
+
+template CollisionPacket<4> collide(
+    const CirclePacket<4>&, const VectorPacket<4>&, const Segment&);
+template CollisionPacket<8> collide(
+    const CirclePacket<8>&, const VectorPacket<8>&, const Segment&);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "geometry.hpp"
+#include "packet.hpp"
 
 #include <limits>
 #include <optional>
@@ -11,18 +12,35 @@ struct Collision {
     Vector movement;
 };
 
+// Collisions of the lanes whose mask bit is set; the other lanes hold
+// unspecified values.
+template <size_t N>
+struct CollisionPacket {
+    std::optional<Collision> operator[](size_t lane) const
+    {
+        if (!laneHit(mask, lane)) {
+            return std::nullopt;
+        }
+        return Collision{position[lane], movement[lane]};
+    }
+
+    PointPacket<N> position;
+    VectorPacket<N> movement;
+    HitMask mask = 0;
+};
+
 std::optional<Collision> bestCollision(
     const Point& start, std::ranges::range auto collisions)
 {
     auto bestCollision = std::optional<Collision>{};
-    auto bestDistance = std::numeric_limits<float>::infinity();
+    auto bestDistance = std::numeric_limits<Scalar>::infinity();
 
     for (const auto& collision : collisions) {
         if (!collision) {
             continue;
         }
 
-        if (float d = distance(start, collision->position); d < bestDistance) {
+        if (Scalar d = distance(start, collision->position); d < bestDistance) {
             bestCollision = collision;
             bestDistance = d;
         }
@@ -47,3 +65,11 @@ std::optional<Collision> collide(
 
 std::optional<Collision> collide(
     const Circle& circle, const Vector& movement, const AxisAlignedRect& rect);
+
+// Packet form of collide(Circle, Vector, Segment) for N independent circles.
+// Lanes with zero movement miss.
+template <size_t N>
+CollisionPacket<N> collide(
+    const CirclePacket<N>& circles,
+    const VectorPacket<N>& movements,
+    const Segment& segment);
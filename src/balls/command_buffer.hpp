@@ -0,0 +1,296 @@
+#pragma once
+
+#include "ecs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Entity created through a command buffer. It only becomes a real entity when
+// the buffer is flushed, but can already be targeted by other commands. The
+// handle is local to the buffer that created it and valid until that buffer
+// is flushed or cleared.
+struct PendingEntity {
+    uint32_t index = 0;
+    uint32_t buffer = 0;
+    uint32_t epoch = 0;
+};
+
+// Records structural changes (create, add, remove, kill) so they can be
+// applied at a sync point instead of while storages are being iterated.
+// Flushing applies the commands in phases: all creates, then adds grouped by
+// component type and sorted by entity, then removes, then kills. Commands on
+// entities that are dead by the time they are applied are dropped.
+template <class Registry>
+class CommandBuffer {
+public:
+    PendingEntity create()
+    {
+        return PendingEntity{
+            .index = _pendingCount++, .buffer = _id, .epoch = _epoch};
+    }
+
+    // The PendingEntity overloads throw std::invalid_argument for a handle
+    // from another buffer or from before the last flush or clear.
+
+    template <class Component>
+    void add(Entity e, Component component)
+    {
+        commands<Component>().adds.emplace_back(Target{e}, std::move(component));
+    }
+
+    template <class Component>
+    void add(PendingEntity e, Component component)
+    {
+        commands<Component>().adds.emplace_back(target(e), std::move(component));
+    }
+
+    template <class Component>
+    void remove(Entity e)
+    {
+        commands<Component>().removes.push_back(Target{e});
+    }
+
+    template <class Component>
+    void remove(PendingEntity e)
+    {
+        commands<Component>().removes.push_back(target(e));
+    }
+
+    void kill(Entity e)
+    {
+        _kills.push_back(Target{e});
+    }
+
+    void kill(PendingEntity e)
+    {
+        _kills.push_back(target(e));
+    }
+
+    bool empty() const
+    {
+        return _pendingCount == 0 && _kills.empty() && std::ranges::all_of(
+            _commands, [] (const auto& pair) { return pair.second->empty(); });
+    }
+
+    void flush(Registry& registry)
+    {
+        flushCreates(registry);
+        flushAdds(registry);
+        flushRemoves(registry);
+
+        auto kills = std::vector<Entity>{};
+        appendKills(kills);
+        std::ranges::sort(kills, {}, &Entity::index);
+        for (Entity e : kills) {
+            registry.kill(e);
+        }
+
+        clear();
+    }
+
+    // Also invalidates the PendingEntity handles created so far.
+    void clear()
+    {
+        _epoch++;
+        _pendingCount = 0;
+        _created.clear();
+        _kills.clear();
+        for (auto& [type, commands] : _commands) {
+            commands->clear();
+        }
+    }
+
+    // The phases below are exposed for CommandQueue, which interleaves them
+    // across several buffers.
+
+    void flushCreates(Registry& registry)
+    {
+        _created.resize(_pendingCount);
+        for (Entity& e : _created) {
+            e = registry.create();
+        }
+    }
+
+    void flushAdds(Registry& registry)
+    {
+        for (auto& [type, commands] : _commands) {
+            commands->flushAdds(registry, _created);
+        }
+    }
+
+    void flushRemoves(Registry& registry)
+    {
+        for (auto& [type, commands] : _commands) {
+            commands->flushRemoves(registry, _created);
+        }
+    }
+
+    void appendKills(std::vector<Entity>& kills) const
+    {
+        for (const Target& target : _kills) {
+            kills.push_back(target.resolve(_created));
+        }
+    }
+
+private:
+    struct Target {
+        static constexpr uint32_t notPending = Entity::nullIndex;
+
+        explicit Target(Entity e)
+            : entity(e)
+        { }
+
+        explicit Target(PendingEntity e)
+            : pending(e.index)
+        { }
+
+        Entity resolve(std::span<const Entity> created) const
+        {
+            return pending == notPending ? entity : created[pending];
+        }
+
+        Entity entity;
+        uint32_t pending = notPending;
+    };
+
+    class AbstractCommands {
+    public:
+        virtual ~AbstractCommands() = default;
+
+        virtual bool empty() const = 0;
+        virtual void clear() = 0;
+        virtual void flushAdds(
+            Registry& registry, std::span<const Entity> created) = 0;
+        virtual void flushRemoves(
+            Registry& registry, std::span<const Entity> created) = 0;
+    };
+
+    template <class Component>
+    class Commands : public AbstractCommands {
+    public:
+        bool empty() const override
+        {
+            return adds.empty() && removes.empty();
+        }
+
+        void clear() override
+        {
+            adds.clear();
+            removes.clear();
+        }
+
+        void flushAdds(
+            Registry& registry, std::span<const Entity> created) override
+        {
+            for (auto& [target, component] : adds) {
+                target = Target{target.resolve(created)};
+            }
+            std::ranges::stable_sort(
+                adds, {}, [] (const auto& add) { return add.first.entity.index(); });
+
+            for (auto& [target, component] : adds) {
+                if (registry.alive(target.entity)) {
+                    registry.template add<Component>(
+                        target.entity, std::move(component));
+                }
+            }
+        }
+
+        void flushRemoves(
+            Registry& registry, std::span<const Entity> created) override
+        {
+            for (const Target& target : removes) {
+                registry.template remove<Component>(target.resolve(created));
+            }
+        }
+
+        std::vector<std::pair<Target, Component>> adds;
+        std::vector<Target> removes;
+    };
+
+    Target target(PendingEntity e) const
+    {
+        if (e.buffer != _id || e.epoch != _epoch || e.index >= _pendingCount) {
+            throw std::invalid_argument{"CommandBuffer: foreign or stale PendingEntity"};
+        }
+        return Target{e};
+    }
+
+    template <class Component>
+    Commands<Component>& commands()
+    {
+        auto& commands = _commands[typeid(Component)];
+        if (!commands) {
+            commands = std::make_unique<Commands<Component>>();
+        }
+        return static_cast<Commands<Component>&>(*commands);
+    }
+
+    static inline std::atomic<uint32_t> _nextId = 1;
+
+    uint32_t _id = _nextId++;
+    uint32_t _epoch = 0;
+    uint32_t _pendingCount = 0;
+    std::vector<Entity> _created;
+    std::vector<Target> _kills;
+    std::unordered_map<std::type_index, std::unique_ptr<AbstractCommands>>
+        _commands;
+};
+
+// A set of per-thread command buffers. Each thread records into its own
+// buffer without contention; flush applies all of them in one batched pass.
+template <class Registry>
+class CommandQueue {
+public:
+    CommandBuffer<Registry>& local()
+    {
+        auto lock = std::scoped_lock{_mutex};
+        auto& buffer = _buffers[std::this_thread::get_id()];
+        if (!buffer) {
+            buffer = std::make_unique<CommandBuffer<Registry>>();
+        }
+        return *buffer;
+    }
+
+    // Must not run concurrently with recording.
+    void flush(Registry& registry)
+    {
+        for (auto& [thread, buffer] : _buffers) {
+            buffer->flushCreates(registry);
+        }
+        for (auto& [thread, buffer] : _buffers) {
+            buffer->flushAdds(registry);
+        }
+        for (auto& [thread, buffer] : _buffers) {
+            buffer->flushRemoves(registry);
+        }
+
+        auto kills = std::vector<Entity>{};
+        for (auto& [thread, buffer] : _buffers) {
+            buffer->appendKills(kills);
+        }
+        std::ranges::sort(kills, {}, &Entity::index);
+        for (Entity e : kills) {
+            registry.kill(e);
+        }
+
+        for (auto& [thread, buffer] : _buffers) {
+            buffer->clear();
+        }
+    }
+
+private:
+    std::mutex _mutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<CommandBuffer<Registry>>>
+        _buffers;
+};
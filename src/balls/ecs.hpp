@@ -1,202 +1,2587 @@
 #pragma once
 
+#include "chunked_vector.hpp"
+#include "soa_vector.hpp"
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <memory>
-#include <queue>
+#include <new>
+#include <numeric>
+#include <ranges>
 #include <span>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <typeindex>
+#include <typeinfo>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+// An entity handle is a slot index plus the generation of that slot at the
+// time the entity was created. Killing an entity bumps its slot's generation,
+// so stale handles never alias entities that later reuse the slot.
 class Entity {
 public:
-    explicit Entity(unsigned long long id)
-        : _id(id)
+    static constexpr uint32_t nullIndex = std::numeric_limits<uint32_t>::max();
+
+    Entity() = default;
+
+    Entity(uint32_t index, uint32_t generation)
+        : _index(index)
+        , _generation(generation)
     { }
 
+    uint32_t index() const
+    {
+        return _index;
+    }
+
+    uint32_t generation() const
+    {
+        return _generation;
+    }
+
+    unsigned long long id() const
+    {
+        return (static_cast<unsigned long long>(_generation) << 32) | _index;
+    }
+
+    bool isNull() const
+    {
+        return _index == nullIndex;
+    }
+
     friend bool operator==(Entity lhs, Entity rhs)
     {
-        return lhs._id == rhs._id;
+        return lhs._index == rhs._index && lhs._generation == rhs._generation;
     }
 
     friend bool operator!=(Entity lhs, Entity rhs)
     {
-        return lhs._id != rhs._id;
+        return !(lhs == rhs);
     }
 
 private:
-    unsigned long long _id = 0;
-
-    friend struct std::hash<Entity>;
+    uint32_t _index = nullIndex;
+    uint32_t _generation = 0;
 };
 
 template <> struct std::hash<Entity>{
     size_t operator()(Entity entity) const noexcept
     {
-        return std::hash<unsigned long long>{}(entity._id);
+        return std::hash<unsigned long long>{}(entity.id());
     }
 };
 
+// Entity slots live in a flat array. Free slots form an intrusive list
+// threaded through that array, so create and kill never allocate once the
+// pool has reached its peak size.
 class EntityPool {
 public:
     Entity create()
     {
-        if (!_killed.empty()) {
-            Entity e = _killed.front();
-            _killed.pop();
-            return e;
+        if (_freeHead != Entity::nullIndex) {
+            uint32_t index = _freeHead;
+            _freeHead = _slots[index].nextFree;
+            _slots[index].nextFree = Entity::nullIndex;
+            return Entity{index, _slots[index].generation};
         }
 
-        return Entity{_next++};
+        auto index = static_cast<uint32_t>(_slots.size());
+        _slots.push_back(Slot{});
+        return Entity{index, 0};
+    }
+
+    // Fills the span with new entities. Free slots are reused first, the rest
+    // are appended to the slot array in one step.
+    void createMany(std::span<Entity> entities)
+    {
+        size_t i = 0;
+        for (; i < entities.size() && _freeHead != Entity::nullIndex; i++) {
+            entities[i] = create();
+        }
+
+        auto index = static_cast<uint32_t>(_slots.size());
+        _slots.resize(_slots.size() + entities.size() - i);
+        for (; i < entities.size(); i++) {
+            entities[i] = Entity{index++, 0};
+        }
     }
 
     void kill(Entity e)
     {
-        _killed.push(e);
+        if (!alive(e)) {
+            return;
+        }
+
+        Slot& slot = _slots[e.index()];
+        slot.generation++;
+        slot.nextFree = _freeHead;
+        _freeHead = e.index();
+    }
+
+    bool alive(Entity e) const
+    {
+        return e.index() < _slots.size() &&
+            _slots[e.index()].generation == e.generation();
+    }
+
+    // Number of slots, live or free; every entity index is below it.
+    size_t size() const
+    {
+        return _slots.size();
+    }
+
+    void save(SnapshotWriter& writer) const
+    {
+        writer.writeRange(std::span{_slots});
+        writer.write(_freeHead);
+    }
+
+    void load(SnapshotReader& reader)
+    {
+        reader.readRange(_slots);
+        reader.read(_freeHead);
+    }
+
+private:
+    struct Slot {
+        uint32_t generation = 0;
+        uint32_t nextFree = Entity::nullIndex;
+    };
+
+    std::vector<Slot> _slots;
+    uint32_t _freeHead = Entity::nullIndex;
+};
+
+// Maps entity slot indices to dense indices. The sparse side is split into
+// fixed-size pages that are allocated when the first slot from their range is
+// inserted and released when the last one is erased, so a lookup is two array
+// reads and sparse slot ranges cost no memory. Generations are not checked
+// here; storages compare the handle stored at the dense index.
+class SparseIndex {
+public:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    bool contains(Entity e) const
+    {
+        return find(e) != npos;
+    }
+
+    size_t find(Entity e) const
+    {
+        size_t page = pageNumber(e);
+        if (page >= _pages.size() || !_pages[page]) {
+            return npos;
+        }
+        return _pages[page]->indices[pageOffset(e)];
+    }
+
+    size_t at(Entity e) const
+    {
+        size_t index = find(e);
+        if (index == npos) {
+            throw std::out_of_range{"SparseIndex::at"};
+        }
+        return index;
+    }
+
+    void set(Entity e, size_t index)
+    {
+        size_t page = pageNumber(e);
+        if (page >= _pages.size()) {
+            _pages.resize(page + 1);
+        }
+        if (!_pages[page]) {
+            _pages[page] = std::make_unique<Page>();
+        }
+
+        size_t& slot = _pages[page]->indices[pageOffset(e)];
+        if (slot == npos) {
+            _pages[page]->used++;
+        }
+        slot = index;
+    }
+
+    void erase(Entity e)
+    {
+        size_t page = pageNumber(e);
+        if (page >= _pages.size() || !_pages[page]) {
+            return;
+        }
+
+        size_t& slot = _pages[page]->indices[pageOffset(e)];
+        if (slot != npos) {
+            slot = npos;
+            if (--_pages[page]->used == 0) {
+                _pages[page].reset();
+            }
+        }
+    }
+
+private:
+    static constexpr size_t pageSize = 4096;
+
+    struct Page {
+        Page()
+        {
+            indices.fill(npos);
+        }
+
+        std::array<size_t, pageSize> indices;
+        size_t used = 0;
+    };
+
+    static size_t pageNumber(Entity e)
+    {
+        return e.index() / pageSize;
+    }
+
+    static size_t pageOffset(Entity e)
+    {
+        return e.index() % pageSize;
+    }
+
+    std::vector<std::unique_ptr<Page>> _pages;
+};
+
+enum class ComponentLayout {
+    // Components in one std::vector; spans over them are available.
+    Contiguous,
+    // Components in fixed-size chunks that never move when the storage grows.
+    Chunked,
+    // One float array per field (see SoaVector). Only for components made of
+    // float fields. Per-entity access goes through proxy references.
+    StructOfArrays,
+};
+
+// Default per-component storage options. To change them for a component type,
+// specialize ComponentTraits for it and derive from this struct.
+struct DefaultComponentTraits {
+    // Record added, modified and removed entities until clearChanges().
+    static constexpr bool trackChanges = false;
+
+    static constexpr ComponentLayout layout = ComponentLayout::Contiguous;
+
+    // Components per chunk for the chunked layout.
+    static constexpr size_t chunkSize = 1024;
+
+    // Leave a hole when a component is removed and reuse it for the next add,
+    // instead of moving the last component into it. With the chunked layout
+    // this keeps every component at a fixed address for its whole lifetime.
+    // Holes show up as null entities in entities().
+    static constexpr bool inPlaceDelete = false;
+};
+
+template <class Component>
+struct ComponentTraits : DefaultComponentTraits {};
+
+namespace detail {
+
+template <class Component, class Traits, ComponentLayout = Traits::layout>
+struct ComponentContainer {
+    using type = std::vector<Component>;
+};
+
+template <class Component, class Traits>
+struct ComponentContainer<Component, Traits, ComponentLayout::Chunked> {
+    using type = ChunkedVector<Component, Traits::chunkSize>;
+};
+
+template <class Component, class Traits>
+struct ComponentContainer<Component, Traits, ComponentLayout::StructOfArrays> {
+    using type = SoaVector<Component>;
+};
+
+} // namespace detail
+
+inline constexpr size_t maxComponentTypes = 128;
+
+namespace detail {
+
+inline size_t nextComponentId()
+{
+    static std::atomic<size_t> next = 0;
+    size_t id = next++;
+    if (id >= maxComponentTypes) {
+        throw std::length_error{"too many component types"};
+    }
+    return id;
+}
+
+} // namespace detail
+
+// Process-wide dense id of a component type, assigned on first use.
+template <class Component>
+size_t componentId()
+{
+    static const size_t id = detail::nextComponentId();
+    return id;
+}
+
+// Set of component ids an entity has, one bit per id.
+class ComponentSignature {
+public:
+    void set(size_t id)
+    {
+        _words[id / 64] |= uint64_t{1} << (id % 64);
+    }
+
+    void reset(size_t id)
+    {
+        _words[id / 64] &= ~(uint64_t{1} << (id % 64));
+    }
+
+    bool test(size_t id) const
+    {
+        return (_words[id / 64] >> (id % 64)) & 1;
+    }
+
+    bool empty() const
+    {
+        return std::ranges::all_of(_words, [] (uint64_t w) { return w == 0; });
+    }
+
+    ComponentSignature& operator|=(const ComponentSignature& other)
+    {
+        for (size_t i = 0; i < _words.size(); i++) {
+            _words[i] |= other._words[i];
+        }
+        return *this;
+    }
+
+    // Calls f(id) for every set bit in ascending order.
+    template <class F>
+    void forEach(F&& f) const
+    {
+        for (size_t word = 0; word < _words.size(); word++) {
+            for (uint64_t bits = _words[word]; bits; bits &= bits - 1) {
+                f(word * 64 + std::countr_zero(bits));
+            }
+        }
+    }
+
+    bool operator==(const ComponentSignature&) const = default;
+
+private:
+    std::array<uint64_t, maxComponentTypes / 64> _words {};
+};
+
+// Entities whose component was added, modified or removed since the last
+// clear. Flags are kept per entity slot so an entity is listed once no matter
+// how often it is touched.
+class ChangeLog {
+public:
+    void markAdded(Entity e)
+    {
+        mark(e, Added);
+    }
+
+    void markModified(Entity e)
+    {
+        mark(e, Modified);
+    }
+
+    // Also drops the entity from changed(), so that re-adding it in the same
+    // frame lists it once.
+    void markRemoved(Entity e)
+    {
+        if (e.index() < _flags.size() && _flags[e.index()] != 0) {
+            uint32_t position = _positions[e.index()];
+            _changed[position] = _changed.back();
+            _positions[_changed[position].index()] = position;
+            _changed.pop_back();
+            _flags[e.index()] = 0;
+        }
+        _removed.push_back(e);
+    }
+
+    bool added(Entity e) const
+    {
+        return e.index() < _flags.size() && (_flags[e.index()] & Added);
+    }
+
+    // May list entities that have since been removed; storages filter those.
+    std::span<const Entity> changed() const
+    {
+        return _changed;
+    }
+
+    std::span<const Entity> removed() const
+    {
+        return _removed;
+    }
+
+    void clear()
+    {
+        for (Entity e : _changed) {
+            if (e.index() < _flags.size()) {
+                _flags[e.index()] = 0;
+            }
+        }
+        _changed.clear();
+        _removed.clear();
     }
 
 private:
-    unsigned long long _next = 1;
-    std::queue<Entity> _killed;
+    enum Flags : uint8_t {
+        Added = 1,
+        Modified = 2,
+    };
+
+    void mark(Entity e, Flags flag)
+    {
+        if (e.index() >= _flags.size()) {
+            _flags.resize(e.index() + 1);
+            _positions.resize(e.index() + 1);
+        }
+        if (_flags[e.index()] == 0) {
+            _positions[e.index()] = static_cast<uint32_t>(_changed.size());
+            _changed.push_back(e);
+        }
+        _flags[e.index()] |= flag;
+    }
+
+    // Per entity index; _positions is only meaningful where _flags is set.
+    std::vector<uint8_t> _flags;
+    std::vector<uint32_t> _positions;
+    std::vector<Entity> _changed;
+    std::vector<Entity> _removed;
+};
+
+// Notified by a storage whenever an entity gains or is about to lose the
+// storage's component. A storage has at most one owner.
+class StorageOwner {
+public:
+    virtual ~StorageOwner() = default;
+
+    virtual void onAdded(Entity e) = 0;
+    virtual void onRemoving(Entity e) = 0;
+
+    // Recomputes the owner's state after its storages were rewritten
+    // wholesale, e.g. by loading a snapshot.
+    virtual void rebuild() = 0;
 };
 
 class AbstractComponentStorage {
 public:
-    ~AbstractComponentStorage() = default;
+    virtual ~AbstractComponentStorage() = default;
+
+    virtual std::string_view typeName() const = 0;
+    virtual std::span<const Entity> entities() const = 0;
 
     virtual void kill(Entity e) = 0;
+    virtual void killMany(std::span<const Entity> entities) = 0;
+    virtual void clear() = 0;
+    virtual void clearChanges() = 0;
+
+    // Snapshots copy the dense arrays as raw bytes and throw
+    // std::logic_error for components that are not trivially copyable.
+    virtual void save(SnapshotWriter& writer) const = 0;
+    virtual void load(SnapshotReader& reader) = 0;
 };
 
 template <class Component>
-class ComponentStorage : public AbstractComponentStorage {
+class ComponentStorage final : public AbstractComponentStorage {
+    using Traits = ComponentTraits<Component>;
+
+    static constexpr bool tracked = Traits::trackChanges;
+    static constexpr bool contiguous =
+        Traits::layout == ComponentLayout::Contiguous;
+    static constexpr bool chunked = Traits::layout == ComponentLayout::Chunked;
+    static constexpr bool split =
+        Traits::layout == ComponentLayout::StructOfArrays;
+    static constexpr bool inPlaceDelete = Traits::inPlaceDelete;
+
+    using Container =
+        typename detail::ComponentContainer<Component, Traits>::type;
+
 public:
-    const Component& component(Entity e) const
+    // Component& and const Component&, except for the struct-of-arrays
+    // layout: a SoaVector::Reference proxy and a Component copy.
+    using reference = decltype(std::declval<Container&>()[0]);
+    using const_reference = decltype(std::declval<const Container&>()[0]);
+
+    bool contains(Entity e) const
     {
-        return _components.at(_entityIndices.at(e));
+        return find(e) != SparseIndex::npos;
     }
 
-    Component& component(Entity e)
+    const_reference component(Entity e) const
+    {
+        return _components[at(e)];
+    }
+
+    reference component(Entity e)
     {
-        return _components.at(_entityIndices.at(e));
+        return _components[at(e)];
     }
 
-    std::span<const Component> components() const
+    std::span<const Component> components() const requires contiguous
     {
         return _components;
     }
 
-    std::span<Component> components()
+    std::span<Component> components() requires contiguous
     {
         return _components;
     }
 
-    std::span<const Entity> entities() const
+    const Container& components() const requires (!contiguous)
+    {
+        return _components;
+    }
+
+    Container& components() requires (!contiguous)
+    {
+        return _components;
+    }
+
+    std::string_view typeName() const override
+    {
+        return typeid(Component).name();
+    }
+
+    std::span<const Entity> entities() const override
     {
         return _entities;
     }
 
-    Component& add(Entity e)
+    // Replaces the component if the entity already has one.
+    reference add(Entity e)
     {
-        size_t index = _entities.size();
-        _entities.push_back(e);
-        _entityIndices.emplace(e, index);
-        return _components.emplace_back();
+        return _components[insert(e)];
     }
 
     void add(Entity e, Component&& component)
     {
-        size_t index = _entities.size();
-        _entities.push_back(e);
-        _entityIndices.emplace(e, index);
-        _components.push_back(std::forward<Component>(component));
+        insert(e, std::move(component));
     }
 
-    void kill(Entity e) override
+    // Adds one component per entity, none of which may have one yet. The
+    // dense arrays are grown once and the sparse index is filled in a single
+    // pass afterwards.
+    template <std::ranges::sized_range R>
+    void addRange(std::span<const Entity> entities, R&& components)
     {
-        size_t index = _entityIndices.at(e);
-        _entityIndices.erase(e);
-        if (index + 1 < _entities.size()) {
-            std::swap(_entities.at(index), _entities.back());
-            std::swap(_components.at(index), _components.back());
-            _entityIndices[_entities.at(index)] = index;
+        if (std::ranges::size(components) != entities.size()) {
+            throw std::invalid_argument{
+                "ComponentStorage::addRange: size mismatch"};
+        }
+        auto present = [this] (Entity e) { return contains(e); };
+        if (std::ranges::any_of(entities, present)) {
+            throw std::invalid_argument{
+                "ComponentStorage::addRange: entity already has the component"};
+        }
+
+        if constexpr (inPlaceDelete) {
+            if (!_freeSlots.empty()) {
+                auto it = std::ranges::begin(components);
+                for (Entity e : entities) {
+                    insert(e, *it++);
+                }
+                return;
+            }
+        }
+
+        size_t first = _entities.size();
+        _entities.insert(_entities.end(), entities.begin(), entities.end());
+        _components.reserve(_entities.size());
+        for (auto&& component : components) {
+            _components.emplace_back(std::forward<decltype(component)>(component));
+        }
+
+        for (size_t i = 0; i < entities.size(); i++) {
+            _entityIndices.set(entities[i], first + i);
+        }
+        if constexpr (tracked) {
+            for (Entity e : entities) {
+                _changes.markAdded(e);
+            }
+        }
+        if (_owner) {
+            for (Entity e : entities) {
+                _owner->onAdded(e);
+            }
         }
     }
 
-private:
-    std::vector<Entity> _entities;
-    std::vector<Component> _components;
-    std::unordered_map<Entity, size_t> _entityIndices;
-};
+    // Mutable access that is recorded as a modification. Writes through
+    // component() or components() are not tracked.
+    reference modify(Entity e)
+    {
+        size_t index = at(e);
+        if constexpr (tracked) {
+            _changes.markModified(e);
+        }
+        return _components[index];
+    }
 
-class ECS {
-public:
-    template <class Component>
-    const Component& component(Entity e) const
+    void markModified(Entity e)
     {
-        return storage<Component>().component(e);
+        if constexpr (tracked) {
+            if (contains(e)) {
+                _changes.markModified(e);
+            }
+        }
     }
 
-    template <class Component>
-    Component& component(Entity e)
+    // Entities added or modified since the last clearChanges(), each listed
+    // once. Empty unless the component's traits enable change tracking.
+    auto changed() const
     {
-        return storage<Component>().component(e);
+        return changes().changed() | std::views::filter(
+            [this] (Entity e) { return contains(e); });
     }
 
-    template <class Component>
-    std::span<const Component> components() const
+    bool added(Entity e) const
     {
-        return storage<Component>().components();
+        return changes().added(e);
     }
 
-    template <class Component>
-    std::span<Component> components()
+    std::span<const Entity> removed() const
     {
-        return storage<Component>().components();
+        return changes().removed();
     }
 
-    template <class Component>
-    std::span<const Entity> entities() const
+    void clearChanges() override
     {
-        return storage<Component>().entities();
+        if constexpr (tracked) {
+            _changes.clear();
+        }
     }
 
-    template <class Component>
-    Component& add(Entity e)
+    void kill(Entity e) override
     {
-        return storage<Component>().add(e);
+        if (_owner && contains(e)) {
+            _owner->onRemoving(e);
+        }
+
+        size_t index = at(e);
+        if constexpr (tracked) {
+            _changes.markRemoved(e);
+        }
+        _entityIndices.erase(e);
+        if constexpr (inPlaceDelete) {
+            _entities[index] = Entity{};
+            _components[index] = Component{};
+            _freeSlots.push_back(index);
+        } else {
+            if (index + 1 < _entities.size()) {
+                _entities[index] = _entities.back();
+                _components[index] = std::move(_components.back());
+                _entityIndices.set(_entities[index], index);
+            }
+            _entities.pop_back();
+            _components.pop_back();
+        }
     }
 
-    template <class Component>
-    void add(Entity e, Component&& component)
+    // Dense position of the entity, or SparseIndex::npos if it has no
+    // component in this storage.
+    size_t index(Entity e) const
     {
-        storage<Component>().add(e, component);
+        return find(e);
     }
 
-    Entity create()
+    void swapEntries(size_t lhs, size_t rhs)
     {
-        return _entityPool.create();
+        if (lhs == rhs) {
+            return;
+        }
+        using std::swap;
+        swap(_entities[lhs], _entities[rhs]);
+        swap(_components[lhs], _components[rhs]);
+        _entityIndices.set(_entities[lhs], lhs);
+        _entityIndices.set(_entities[rhs], rhs);
     }
 
-    void kill(Entity e)
+    // Reorders the dense arrays by ascending key(entity), e.g. the Morton key
+    // of the entity's position so that entities close in space are close in
+    // memory. Throws std::logic_error if a group owns the storage, since the
+    // group dictates the order.
+    template <class Key>
+    requires (!inPlaceDelete)
+    void sort(Key&& key)
     {
-        for (const auto& [typeIndex, storage] : _componentStorages) {
-            storage->kill(e);
+        auto keys = sortKeys(key);
+        auto order = std::vector<size_t>(keys.size());
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::ranges::stable_sort(order, {}, [&keys] (size_t i) { return keys[i]; });
+
+        auto entities = std::vector<Entity>{};
+        auto components = Container{};
+        entities.reserve(order.size());
+        components.reserve(order.size());
+        for (size_t i : order) {
+            entities.push_back(_entities[i]);
+            components.emplace_back(std::move(_components[i]));
+        }
+        _entities = std::move(entities);
+        _components = std::move(components);
+
+        for (size_t i = 0; i < _entities.size(); i++) {
+            _entityIndices.set(_entities[i], i);
         }
-        _entityPool.kill(e);
     }
 
-private:
-    template <class Component>
-    ComponentStorage<Component> storage()
+    // Runs an insertion sort by key for at most maxMoves swaps and returns
+    // whether the storage ended up sorted. Entities move little between
+    // frames, so a small budget per frame keeps an earlier sort() from
+    // decaying without a full pass.
+    template <class Key>
+    requires (!inPlaceDelete)
+    bool sortIncremental(Key&& key, size_t maxMoves)
     {
-        return static_cast<ComponentStorage<Component>&>(
-            *_componentStorages.at(typeid(Component)));
+        auto keys = sortKeys(key);
+        for (size_t i = 1; i < keys.size(); i++) {
+            for (size_t j = i; j > 0 && keys[j] < keys[j - 1]; j--) {
+                if (maxMoves-- == 0) {
+                    return false;
+                }
+                std::swap(keys[j], keys[j - 1]);
+                swapEntries(j, j - 1);
+            }
+        }
+        return true;
     }
 
-    EntityPool _entityPool;
-    std::unordered_map<
-        std::type_index,
-        std::unique_ptr<AbstractComponentStorage>
-    > _componentStorages;
-};
\ No newline at end of file
+    // Removes the components of those entities that have one. The sparse
+    // entries are erased first, then the remaining rows are compacted in
+    // order in one pass, re-indexing only the rows that moved. Small batches,
+    // in-place-delete storages and storages owned by a group go through
+    // kill(), which moves at most one row per entity.
+    void killMany(std::span<const Entity> entities) override
+    {
+        if (inPlaceDelete || _owner || entities.size() * 8 < _entities.size()) {
+            for (Entity e : entities) {
+                if (contains(e)) {
+                    kill(e);
+                }
+            }
+            return;
+        }
+
+        size_t first = _entities.size();
+        for (Entity e : entities) {
+            size_t index = find(e);
+            if (index == SparseIndex::npos) {
+                continue;
+            }
+            if constexpr (tracked) {
+                _changes.markRemoved(e);
+            }
+            _entityIndices.erase(e);
+            first = std::min(first, index);
+        }
+
+        size_t kept = first;
+        for (size_t i = first; i < _entities.size(); i++) {
+            if (find(_entities[i]) == SparseIndex::npos) {
+                continue;
+            }
+            if (kept != i) {
+                _entities[kept] = _entities[i];
+                _components[kept] = std::move(_components[i]);
+                _entityIndices.set(_entities[kept], kept);
+            }
+            kept++;
+        }
+        _entities.resize(kept);
+        while (_components.size() > kept) {
+            _components.pop_back();
+        }
+    }
+
+    // Drops every component without notifying the owner or change tracking.
+    void clear() override
+    {
+        _entities.clear();
+        _components.clear();
+        _freeSlots.clear();
+        _entityIndices = SparseIndex{};
+        clearChanges();
+    }
+
+    void save(SnapshotWriter& writer) const override
+    {
+        if constexpr (!std::is_trivially_copyable_v<Component>) {
+            (void)writer;
+            throw std::logic_error{"component is not trivially copyable"};
+        } else {
+            writer.writeRange(std::span{_entities});
+            writer.writeRange(std::span{_freeSlots});
+            if constexpr (chunked) {
+                for (size_t i = 0; i < _components.chunkCount(); i++) {
+                    writer.writeBytes(std::as_bytes(_components.chunk(i)));
+                }
+            } else if constexpr (split) {
+                for (size_t i = 0; i < Container::laneCount; i++) {
+                    writer.writeBytes(std::as_bytes(_components.lane(i)));
+                }
+            } else {
+                writer.writeBytes(std::as_bytes(std::span{_components}));
+            }
+        }
+    }
+
+    // Restores the storage from a snapshot. The sparse index is rebuilt from
+    // the entity array and change tracking starts over.
+    void load(SnapshotReader& reader) override
+    {
+        if constexpr (!std::is_trivially_copyable_v<Component>) {
+            (void)reader;
+            throw std::logic_error{"component is not trivially copyable"};
+        } else {
+            reader.readRange(_entities);
+            reader.readRange(_freeSlots);
+            if constexpr (chunked) {
+                _components.clear();
+                _components.reserve(_entities.size());
+                while (_components.size() < _entities.size()) {
+                    _components.emplace_back();
+                }
+                for (size_t i = 0; i < _components.chunkCount(); i++) {
+                    reader.readBytes(std::as_writable_bytes(_components.chunk(i)));
+                }
+            } else if constexpr (split) {
+                _components.resize(_entities.size());
+                for (size_t i = 0; i < Container::laneCount; i++) {
+                    reader.readBytes(std::as_writable_bytes(_components.lane(i)));
+                }
+            } else {
+                _components.resize(_entities.size());
+                reader.readBytes(std::as_writable_bytes(std::span{_components}));
+            }
+
+            _entityIndices = SparseIndex{};
+            for (size_t i = 0; i < _entities.size(); i++) {
+                if (!_entities[i].isNull()) {
+                    _entityIndices.set(_entities[i], i);
+                }
+            }
+            clearChanges();
+        }
+    }
+
+    StorageOwner* owner() const
+    {
+        return _owner;
+    }
+
+    void setOwner(StorageOwner* owner)
+    {
+        if (owner && _owner && owner != _owner) {
+            throw std::logic_error{"component storage already has an owner"};
+        }
+        _owner = owner;
+    }
+
+private:
+    // An entity that already has the component keeps its row and gets the
+    // new value, which is what ArchetypeECS does too.
+    template <class... Args>
+    size_t insert(Entity e, Args&&... args)
+    {
+        if (size_t existing = find(e); existing != SparseIndex::npos) {
+            _components[existing] = Component(std::forward<Args>(args)...);
+            if constexpr (tracked) {
+                _changes.markModified(e);
+            }
+            return existing;
+        }
+
+        size_t index = _entities.size();
+        bool reused = false;
+        if constexpr (inPlaceDelete) {
+            if (!_freeSlots.empty()) {
+                index = _freeSlots.back();
+                _freeSlots.pop_back();
+                _entities[index] = e;
+                _components[index] = Component(std::forward<Args>(args)...);
+                reused = true;
+            }
+        }
+        if (!reused) {
+            _entities.push_back(e);
+            _components.emplace_back(std::forward<Args>(args)...);
+        }
+
+        _entityIndices.set(e, index);
+        if constexpr (tracked) {
+            _changes.markAdded(e);
+        }
+        if (_owner) {
+            _owner->onAdded(e);
+            index = at(e);
+        }
+        return index;
+    }
+
+    template <class Key>
+    auto sortKeys(Key& key) const
+    {
+        if (_owner) {
+            throw std::logic_error{"cannot sort a storage owned by a group"};
+        }
+        auto keys = std::vector<std::decay_t<std::invoke_result_t<Key&, Entity>>>{};
+        keys.reserve(_entities.size());
+        for (Entity e : _entities) {
+            keys.push_back(key(e));
+        }
+        return keys;
+    }
+
+    size_t find(Entity e) const
+    {
+        size_t index = _entityIndices.find(e);
+        if (index == SparseIndex::npos || _entities[index] != e) {
+            return SparseIndex::npos;
+        }
+        return index;
+    }
+
+    size_t at(Entity e) const
+    {
+        size_t index = find(e);
+        if (index == SparseIndex::npos) {
+            throw std::out_of_range{"ComponentStorage::at"};
+        }
+        return index;
+    }
+
+    const ChangeLog& changes() const
+    {
+        if constexpr (tracked) {
+            return _changes;
+        } else {
+            static const ChangeLog empty;
+            return empty;
+        }
+    }
+
+    struct NoChangeLog {};
+
+    std::vector<Entity> _entities;
+    Container _components;
+    std::vector<size_t> _freeSlots;
+    SparseIndex _entityIndices;
+    std::conditional_t<tracked, ChangeLog, NoChangeLog> _changes;
+    StorageOwner* _owner = nullptr;
+};
+
+// Owns several storages and keeps the entities that have all of their
+// components packed at the front of each storage, in the same order. Iterating
+// the group is a zip of the leading parts of the dense arrays without any
+// lookups. A storage can be owned by only one group at a time.
+template <class... Owned>
+class OwningGroup final : public StorageOwner {
+    static_assert(
+        ((ComponentTraits<Owned>::layout == ComponentLayout::Contiguous &&
+            !ComponentTraits<Owned>::inPlaceDelete) && ...),
+        "owning groups need contiguous storages that move on delete");
+
+public:
+    using value_type = std::tuple<Entity, Owned&...>;
+
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = OwningGroup::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type;
+        using pointer = void;
+
+        Iterator() = default;
+
+        Iterator(const OwningGroup* group, size_t index)
+            : _group(group)
+            , _index(index)
+        { }
+
+        reference operator*() const
+        {
+            return _group->get(_index);
+        }
+
+        Iterator& operator++()
+        {
+            ++_index;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs)
+        {
+            return lhs._index == rhs._index;
+        }
+
+    private:
+        const OwningGroup* _group = nullptr;
+        size_t _index = 0;
+    };
+
+    explicit OwningGroup(ComponentStorage<Owned>&... storages)
+        : _storages{&storages...}
+    {
+        if ((storages.owner() || ...)) {
+            throw std::logic_error{"component storage already has an owner"};
+        }
+        (storages.setOwner(this), ...);
+
+        auto candidates = std::vector<Entity>{};
+        std::ranges::copy(
+            std::get<0>(_storages)->entities(), std::back_inserter(candidates));
+        for (Entity e : candidates) {
+            onAdded(e);
+        }
+    }
+
+    OwningGroup(const OwningGroup&) = delete;
+    OwningGroup(OwningGroup&&) = delete;
+    OwningGroup& operator=(const OwningGroup&) = delete;
+    OwningGroup& operator=(OwningGroup&&) = delete;
+
+    ~OwningGroup() override
+    {
+        std::apply(
+            [] (auto*... storage) { (storage->setOwner(nullptr), ...); },
+            _storages);
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    std::span<const Entity> entities() const
+    {
+        return std::get<0>(_storages)->entities().first(_size);
+    }
+
+    template <class Component>
+    std::span<Component> components() const
+    {
+        return std::get<ComponentStorage<Component>*>(_storages)
+            ->components().first(_size);
+    }
+
+    Iterator begin() const
+    {
+        return Iterator{this, 0};
+    }
+
+    Iterator end() const
+    {
+        return Iterator{this, _size};
+    }
+
+    value_type get(size_t index) const
+    {
+        return value_type{
+            entities()[index],
+            std::get<ComponentStorage<Owned>*>(_storages)
+                ->components()[index]...};
+    }
+
+    template <class F>
+    void each(F&& f) const
+    {
+        auto entities = this->entities();
+        auto columns = std::tuple{components<Owned>()...};
+        for (size_t i = 0; i < _size; i++) {
+            std::apply(
+                [&] (const auto&... column) { f(entities[i], column[i]...); },
+                columns);
+        }
+    }
+
+    void onAdded(Entity e) override
+    {
+        if (!grouped(e) && hasAll(e)) {
+            std::apply(
+                [this, e] (auto*... storage) {
+                    (storage->swapEntries(storage->index(e), _size), ...);
+                },
+                _storages);
+            _size++;
+        }
+    }
+
+    // Storages keep the grouped entities at the front, so after a wholesale
+    // restore the group is the longest prefix that has every component.
+    void rebuild() override
+    {
+        auto entities = std::get<0>(_storages)->entities();
+        _size = 0;
+        while (_size < entities.size() && hasAll(entities[_size])) {
+            _size++;
+        }
+    }
+
+    void onRemoving(Entity e) override
+    {
+        if (grouped(e)) {
+            _size--;
+            std::apply(
+                [this, e] (auto*... storage) {
+                    (storage->swapEntries(storage->index(e), _size), ...);
+                },
+                _storages);
+        }
+    }
+
+private:
+    bool hasAll(Entity e) const
+    {
+        return std::apply(
+            [e] (const auto*... storage) { return (storage->contains(e) && ...); },
+            _storages);
+    }
+
+    bool grouped(Entity e) const
+    {
+        return std::get<0>(_storages)->index(e) < _size;
+    }
+
+    std::tuple<ComponentStorage<Owned>*...> _storages;
+    size_t _size = 0;
+};
+
+// Joins several component storages. Iteration walks the entities of the
+// smallest storage and probes the rest through their sparse indices, yielding
+// (entity, components...) tuples of references. A const component type gives
+// read-only access to that component.
+template <class... Components>
+class ComponentView {
+    template <class Component>
+    using StoragePtr = std::conditional_t<
+        std::is_const_v<Component>,
+        const ComponentStorage<std::remove_const_t<Component>>*,
+        ComponentStorage<Component>*>;
+
+    template <class Component>
+    using Reference = std::conditional_t<
+        std::is_const_v<Component>,
+        typename ComponentStorage<std::remove_const_t<Component>>::const_reference,
+        typename ComponentStorage<std::remove_const_t<Component>>::reference>;
+
+public:
+    using value_type = std::tuple<Entity, Reference<Components>...>;
+
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ComponentView::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type;
+        using pointer = void;
+
+        Iterator() = default;
+
+        Iterator(const ComponentView* view, const Entity* it, const Entity* end)
+            : _view(view)
+            , _it(it)
+            , _end(end)
+        {
+            skipMissing();
+        }
+
+        reference operator*() const
+        {
+            return _view->get(*_it);
+        }
+
+        Iterator& operator++()
+        {
+            ++_it;
+            skipMissing();
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs)
+        {
+            return lhs._it == rhs._it;
+        }
+
+    private:
+        void skipMissing()
+        {
+            while (_it != _end && !_view->contains(*_it)) {
+                ++_it;
+            }
+        }
+
+        const ComponentView* _view = nullptr;
+        const Entity* _it = nullptr;
+        const Entity* _end = nullptr;
+    };
+
+    explicit ComponentView(StoragePtr<Components>... storages)
+        : _storages{storages...}
+    {
+        _driving = std::get<0>(_storages)->entities();
+        std::apply(
+            [this] (const auto&... storage) {
+                ((storage->entities().size() < _driving.size()
+                    ? (void)(_driving = storage->entities())
+                    : (void)0), ...);
+            },
+            _storages);
+    }
+
+    Iterator begin() const
+    {
+        return Iterator{this, _driving.data(), _driving.data() + _driving.size()};
+    }
+
+    Iterator end() const
+    {
+        auto last = _driving.data() + _driving.size();
+        return Iterator{this, last, last};
+    }
+
+    bool contains(Entity e) const
+    {
+        return std::apply(
+            [e] (const auto&... storage) {
+                return (storage->contains(e) && ...);
+            },
+            _storages);
+    }
+
+    value_type get(Entity e) const
+    {
+        return std::apply(
+            [e] (const auto&... storage) {
+                return value_type{e, storage->component(e)...};
+            },
+            _storages);
+    }
+
+    template <class F>
+    void each(F&& f) const
+    {
+        for (Entity e : _driving) {
+            if (contains(e)) {
+                std::apply(f, get(e));
+            }
+        }
+    }
+
+private:
+    std::tuple<StoragePtr<Components>...> _storages;
+    std::span<const Entity> _driving;
+};
+
+class ECS {
+public:
+    template <class Component>
+    decltype(auto) component(Entity e) const
+    {
+        return storage<Component>().component(e);
+    }
+
+    template <class Component>
+    decltype(auto) component(Entity e)
+    {
+        return storage<Component>().component(e);
+    }
+
+    template <class Component>
+    decltype(auto) components() const
+    {
+        return storage<Component>().components();
+    }
+
+    template <class Component>
+    decltype(auto) components()
+    {
+        return storage<Component>().components();
+    }
+
+    template <class Component>
+    std::span<const Entity> entities() const
+    {
+        return storage<Component>().entities();
+    }
+
+    template <class Component>
+    bool has(Entity e) const
+    {
+        return alive(e) &&
+            _signatures[e.index()].test(componentId<Component>());
+    }
+
+    template <class Component>
+    decltype(auto) add(Entity e)
+    {
+        signature(e).set(componentId<Component>());
+        return storage<Component>().add(e);
+    }
+
+    template <class Component>
+    void add(Entity e, Component&& component)
+    {
+        signature(e).set(componentId<Component>());
+        storage<Component>().add(e, std::move(component));
+    }
+
+    template <class Component>
+    void remove(Entity e)
+    {
+        if (has<Component>(e)) {
+            _signatures[e.index()].reset(componentId<Component>());
+            storage<Component>().kill(e);
+        }
+    }
+
+    template <class Component>
+    decltype(auto) modify(Entity e)
+    {
+        return storage<Component>().modify(e);
+    }
+
+    template <class Component>
+    void markModified(Entity e)
+    {
+        storage<Component>().markModified(e);
+    }
+
+    template <class Component>
+    auto changed() const
+    {
+        return storage<Component>().changed();
+    }
+
+    template <class Component>
+    std::span<const Entity> removed() const
+    {
+        return storage<Component>().removed();
+    }
+
+    template <class... Components>
+    requires (sizeof...(Components) > 0)
+    ComponentView<Components...> view()
+    {
+        return ComponentView<Components...>{
+            &storage<std::remove_const_t<Components>>()...};
+    }
+
+    // Creates the group on first use. Throws if one of the storages is
+    // already owned by a different group.
+    template <class... Owned>
+    requires (sizeof...(Owned) > 1)
+    OwningGroup<Owned...>& group()
+    {
+        auto it = _groups.find(typeid(OwningGroup<Owned...>));
+        if (it == _groups.end()) {
+            it = _groups.emplace(
+                typeid(OwningGroup<Owned...>),
+                std::make_unique<OwningGroup<Owned...>>(storage<Owned>()...))
+                .first;
+        }
+        return static_cast<OwningGroup<Owned...>&>(*it->second);
+    }
+
+    template <class Component, std::ranges::sized_range R>
+    void addRange(std::span<const Entity> entities, R&& components)
+    {
+        auto isAlive = [this] (Entity e) { return alive(e); };
+        if (!std::ranges::all_of(entities, isAlive)) {
+            throw std::out_of_range{"ECS::addRange: entity is not alive"};
+        }
+        storage<Component>().addRange(entities, std::forward<R>(components));
+        for (Entity e : entities) {
+            signature(e).set(componentId<Component>());
+        }
+    }
+
+    // Reorders the component's storage by key(entity). With a Morton key of
+    // the position (see morton.hpp), spatial neighbours end up adjacent.
+    template <class Component, class Key>
+    void sort(Key&& key)
+    {
+        storage<Component>().sort(std::forward<Key>(key));
+    }
+
+    template <class Component, class Key>
+    bool sortIncremental(Key&& key, size_t maxMoves)
+    {
+        return storage<Component>().sortIncremental(
+            std::forward<Key>(key), maxMoves);
+    }
+
+    Entity create()
+    {
+        Entity e = _entityPool.create();
+        if (e.index() >= _signatures.size()) {
+            _signatures.resize(e.index() + 1);
+        }
+        return e;
+    }
+
+    std::vector<Entity> createMany(size_t count)
+    {
+        auto entities = std::vector<Entity>(count);
+        _entityPool.createMany(entities);
+        _signatures.resize(std::max(_signatures.size(), _entityPool.size()));
+        return entities;
+    }
+
+    bool alive(Entity e) const
+    {
+        return _entityPool.alive(e);
+    }
+
+    // Visits only the storages named in the entity's signature.
+    void kill(Entity e)
+    {
+        if (!alive(e)) {
+            return;
+        }
+
+        ComponentSignature& signature = _signatures[e.index()];
+        signature.forEach([this, e] (size_t id) {
+            _storages[id]->kill(e);
+        });
+        signature = ComponentSignature{};
+        _entityPool.kill(e);
+    }
+
+    // Dead and duplicate entities are skipped. Every storage named in one of
+    // the signatures removes its part of the batch in a single killMany.
+    void killMany(std::span<const Entity> entities)
+    {
+        auto killed = std::vector<Entity>{};
+        auto touched = ComponentSignature{};
+        for (Entity e : entities) {
+            if (!alive(e)) {
+                continue;
+            }
+            ComponentSignature& signature = _signatures[e.index()];
+            touched |= signature;
+            signature = ComponentSignature{};
+            _entityPool.kill(e);
+            killed.push_back(e);
+        }
+        touched.forEach([this, &killed] (size_t id) {
+            _storages[id]->killMany(killed);
+        });
+    }
+
+    // Starts a new change-tracking frame for every storage.
+    void clearChanges()
+    {
+        for (const auto& storage : _storages) {
+            if (storage) {
+                storage->clearChanges();
+            }
+        }
+    }
+
+    // Storages are written in order of their type names, which are only
+    // stable within one build of the program.
+    void save(SnapshotWriter& writer) const
+    {
+        _entityPool.save(writer);
+
+        auto storages = std::vector<
+            std::pair<std::string_view, const AbstractComponentStorage*>>{};
+        for (const auto& storage : _storages) {
+            if (storage) {
+                storages.emplace_back(storage->typeName(), storage.get());
+            }
+        }
+        std::ranges::sort(storages);
+
+        writer.write(storages.size());
+        for (const auto& [name, storage] : storages) {
+            writer.writeRange(std::span{name});
+            storage->save(writer);
+        }
+    }
+
+    // Every storage in the snapshot must already be registered, e.g. by an
+    // earlier add or view. Registered storages missing from it end up empty.
+    // Signatures are rebuilt from the loaded storages.
+    void load(SnapshotReader& reader)
+    {
+        _entityPool.load(reader);
+
+        auto loaded = std::vector<AbstractComponentStorage*>{};
+        auto count = reader.read<size_t>();
+        auto name = std::vector<char>{};
+        for (size_t i = 0; i < count; i++) {
+            reader.readRange(name);
+            auto it = std::ranges::find_if(
+                _storages,
+                [&name] (const auto& storage) {
+                    return storage &&
+                        std::ranges::equal(storage->typeName(), name);
+                });
+            if (it == _storages.end()) {
+                throw std::out_of_range{"ECS::load: unknown component storage"};
+            }
+            (*it)->load(reader);
+            loaded.push_back(it->get());
+        }
+
+        _signatures.assign(_entityPool.size(), ComponentSignature{});
+        for (size_t id = 0; id < _storages.size(); id++) {
+            AbstractComponentStorage* storage = _storages[id].get();
+            if (!storage) {
+                continue;
+            }
+            if (std::ranges::find(loaded, storage) == loaded.end()) {
+                storage->clear();
+            }
+            for (Entity e : storage->entities()) {
+                if (!e.isNull()) {
+                    signature(e).set(id);
+                }
+            }
+        }
+
+        for (const auto& [typeIndex, group] : _groups) {
+            group->rebuild();
+        }
+    }
+
+private:
+    // Signatures are sized by create and load, so every live entity has one.
+    ComponentSignature& signature(Entity e)
+    {
+        if (!alive(e)) {
+            throw std::out_of_range{"ECS::signature: entity is not alive"};
+        }
+        return _signatures[e.index()];
+    }
+
+    template <class Component>
+    ComponentStorage<Component>& storage()
+    {
+        size_t id = componentId<Component>();
+        if (id >= _storages.size()) {
+            _storages.resize(id + 1);
+        }
+        if (!_storages[id]) {
+            _storages[id] = std::make_unique<ComponentStorage<Component>>();
+        }
+        return static_cast<ComponentStorage<Component>&>(*_storages[id]);
+    }
+
+    template <class Component>
+    const ComponentStorage<Component>& storage() const
+    {
+        size_t id = componentId<Component>();
+        if (id >= _storages.size() || !_storages[id]) {
+            throw std::out_of_range{"ECS::storage: component not registered"};
+        }
+        return static_cast<const ComponentStorage<Component>&>(*_storages[id]);
+    }
+
+    EntityPool _entityPool;
+    std::vector<ComponentSignature> _signatures;
+    std::vector<std::unique_ptr<AbstractComponentStorage>> _storages;
+    std::unordered_map<std::type_index, std::unique_ptr<StorageOwner>> _groups;
+};
+
+// ECS with a fixed set of component types known at compile time. Storages
+// live in a tuple, so component access resolves statically and kill is a fold
+// over the storages instead of a virtual call per registered type. The
+// dynamic ECS remains for tools that register components at run time.
+// Groups refer to the storages by address, so the registry is not movable.
+template <class... Registered>
+class StaticECS {
+    template <class Component>
+    static constexpr bool isRegistered =
+        (std::is_same_v<std::remove_const_t<Component>, Registered> || ...);
+
+    static_assert(sizeof...(Registered) <= maxComponentTypes);
+
+    // Signature bit of a registered component: its position in the pack.
+    template <class Component>
+    static constexpr size_t slot = [] {
+        size_t i = 0;
+        ((std::is_same_v<std::remove_const_t<Component>, Registered> ?
+            false : (++i, true)) && ...);
+        return i;
+    }();
+
+public:
+    StaticECS() = default;
+    StaticECS(const StaticECS&) = delete;
+    StaticECS(StaticECS&&) = delete;
+    StaticECS& operator=(const StaticECS&) = delete;
+    StaticECS& operator=(StaticECS&&) = delete;
+    ~StaticECS() = default;
+
+    template <class Component>
+    requires isRegistered<Component>
+    decltype(auto) component(Entity e) const
+    {
+        return storage<Component>().component(e);
+    }
+
+    template <class Component>
+    requires isRegistered<Component>
+    decltype(auto) component(Entity e)
+    {
+        return storage<Component>().component(e);
+    }
+
+    template <class Component>
+    requires isRegistered<Component>
+    decltype(auto) components() const
+    {
+        return storage<Component>().components();
+    }
+
+    template <class Component>
+    requires isRegistered<Component>
+    decltype(auto) components()
+    {
+        return storage<Component>().components();
+    }
+
+    template <class Component>
+    requires isRegistered<Component>
+    std::span<const Entity> entities() const
+    {
+        return storage<Component>().entities();
+    }
+
+    template <class Component>
+    requires isRegistered<Component>
+    bool has(Entity e) const
+    {
+        return alive(e) && _signatures[e.index()].test(slot<Component>);
+    }
+
+    template <class Component>
+    requires isRegistered<Component>
+    decltype(auto) add(Entity e)
+    {
+        signature(e).set(slot<Component>);
+        return storage<Component>().add(e);
+    }
+
+    template <class Component>
+    requires isRegistered<Component>
+    void add(Entity e, Component&& component)
+    {
+        signature(e).set(slot<Component>);
+        storage<Component>().add(e, std::move(component));
+    }
+
+    template <class Component>
+    requires isRegistered<Component>
+    void remove(Entity e)
+    {
+        if (has<Component>(e)) {
+            _signatures[e.index()].reset(slot<Component>);
+            storage<Component>().kill(e);
+        }
+    }
+
+    template <class Component>
+    requires isRegistered<Component>
+    decltype(auto) modify(Entity e)
+    {
+        return storage<Component>().modify(e);
+    }
+
+    template <class Component>
+    requires isRegistered<Component>
+    void markModified(Entity e)
+    {
+        storage<Component>().markModified(e);
+    }
+
+    template <class Component>
+    requires isRegistered<Component>
+    auto changed() const
+    {
+        return storage<Component>().changed();
+    }
+
+    template <class Component>
+    requires isRegistered<Component>
+    std::span<const Entity> removed() const
+    {
+        return storage<Component>().removed();
+    }
+
+    template <class... Components>
+    requires (sizeof...(Components) > 0) && (isRegistered<Components> && ...)
+    ComponentView<Components...> view()
+    {
+        return ComponentView<Components...>{
+            &storage<std::remove_const_t<Components>>()...};
+    }
+
+    template <class... Owned>
+    requires (sizeof...(Owned) > 1) && (isRegistered<Owned> && ...)
+    OwningGroup<Owned...>& group()
+    {
+        auto it = _groups.find(typeid(OwningGroup<Owned...>));
+        if (it == _groups.end()) {
+            it = _groups.emplace(
+                typeid(OwningGroup<Owned...>),
+                std::make_unique<OwningGroup<Owned...>>(storage<Owned>()...))
+                .first;
+        }
+        return static_cast<OwningGroup<Owned...>&>(*it->second);
+    }
+
+    template <class Component, std::ranges::sized_range R>
+    requires isRegistered<Component>
+    void addRange(std::span<const Entity> entities, R&& components)
+    {
+        auto isAlive = [this] (Entity e) { return alive(e); };
+        if (!std::ranges::all_of(entities, isAlive)) {
+            throw std::out_of_range{"StaticECS::addRange: entity is not alive"};
+        }
+        storage<Component>().addRange(entities, std::forward<R>(components));
+        for (Entity e : entities) {
+            signature(e).set(slot<Component>);
+        }
+    }
+
+    // Reorders the component's storage by key(entity). With a Morton key of
+    // the position (see morton.hpp), spatial neighbours end up adjacent.
+    template <class Component, class Key>
+    requires isRegistered<Component>
+    void sort(Key&& key)
+    {
+        storage<Component>().sort(std::forward<Key>(key));
+    }
+
+    template <class Component, class Key>
+    requires isRegistered<Component>
+    bool sortIncremental(Key&& key, size_t maxMoves)
+    {
+        return storage<Component>().sortIncremental(
+            std::forward<Key>(key), maxMoves);
+    }
+
+    Entity create()
+    {
+        Entity e = _entityPool.create();
+        if (e.index() >= _signatures.size()) {
+            _signatures.resize(e.index() + 1);
+        }
+        return e;
+    }
+
+    std::vector<Entity> createMany(size_t count)
+    {
+        auto entities = std::vector<Entity>(count);
+        _entityPool.createMany(entities);
+        _signatures.resize(std::max(_signatures.size(), _entityPool.size()));
+        return entities;
+    }
+
+    bool alive(Entity e) const
+    {
+        return _entityPool.alive(e);
+    }
+
+    // Only storages whose bit is set in the entity's signature are touched.
+    void kill(Entity e)
+    {
+        if (!alive(e)) {
+            return;
+        }
+
+        ComponentSignature& signature = _signatures[e.index()];
+        ((signature.test(slot<Registered>) ?
+            storage<Registered>().kill(e) : void()), ...);
+        signature = ComponentSignature{};
+        _entityPool.kill(e);
+    }
+
+    // Dead and duplicate entities are skipped. Each storage named in one of
+    // the signatures removes its part of the batch in a single killMany.
+    void killMany(std::span<const Entity> entities)
+    {
+        auto killed = std::vector<Entity>{};
+        auto touched = ComponentSignature{};
+        for (Entity e : entities) {
+            if (!alive(e)) {
+                continue;
+            }
+            ComponentSignature& signature = _signatures[e.index()];
+            touched |= signature;
+            signature = ComponentSignature{};
+            _entityPool.kill(e);
+            killed.push_back(e);
+        }
+        ((touched.test(slot<Registered>) ?
+            storage<Registered>().killMany(killed) : void()), ...);
+    }
+
+    void clearChanges()
+    {
+        (storage<Registered>().clearChanges(), ...);
+    }
+
+    void save(SnapshotWriter& writer) const
+    {
+        _entityPool.save(writer);
+        (storage<Registered>().save(writer), ...);
+    }
+
+    void load(SnapshotReader& reader)
+    {
+        _entityPool.load(reader);
+        (storage<Registered>().load(reader), ...);
+
+        _signatures.assign(_entityPool.size(), ComponentSignature{});
+        (setSignatures<Registered>(), ...);
+
+        for (const auto& [typeIndex, group] : _groups) {
+            group->rebuild();
+        }
+    }
+
+private:
+    // Signatures are sized by create and load, so every live entity has one.
+    ComponentSignature& signature(Entity e)
+    {
+        if (!alive(e)) {
+            throw std::out_of_range{"StaticECS::signature: entity is not alive"};
+        }
+        return _signatures[e.index()];
+    }
+
+    template <class Component>
+    void setSignatures()
+    {
+        for (Entity e : storage<Component>().entities()) {
+            if (!e.isNull()) {
+                signature(e).set(slot<Component>);
+            }
+        }
+    }
+
+    template <class Component>
+    ComponentStorage<Component>& storage()
+    {
+        return std::get<ComponentStorage<Component>>(_storages);
+    }
+
+    template <class Component>
+    const ComponentStorage<Component>& storage() const
+    {
+        return std::get<ComponentStorage<Component>>(_storages);
+    }
+
+    EntityPool _entityPool;
+    std::vector<ComponentSignature> _signatures;
+    std::tuple<ComponentStorage<Registered>...> _storages;
+    std::unordered_map<std::type_index, std::unique_ptr<StorageOwner>> _groups;
+};
+
+// Type-erased description of a component type, used by archetype chunks to
+// lay out and move columns without knowing their static types.
+struct ComponentType {
+    template <class Component>
+    static const ComponentType* of()
+    {
+        static const ComponentType type{
+            .index = typeid(Component),
+            .size = sizeof(Component),
+            .alignment = alignof(Component),
+            .construct = [] (void* ptr) {
+                new (ptr) Component{};
+            },
+            .moveConstruct = [] (void* dst, void* src) {
+                new (dst) Component{std::move(*static_cast<Component*>(src))};
+            },
+            .destroy = [] (void* ptr) {
+                static_cast<Component*>(ptr)->~Component();
+            },
+        };
+        return &type;
+    }
+
+    std::type_index index;
+    size_t size = 0;
+    size_t alignment = 0;
+    void (*construct)(void* ptr) = nullptr;
+    void (*moveConstruct)(void* dst, void* src) = nullptr;
+    void (*destroy)(void* ptr) = nullptr;
+};
+
+// All entities with exactly the same set of components. Rows are packed into
+// fixed-size chunks, each holding an entity array followed by one array per
+// component, so iterating a component set touches only contiguous memory.
+class Archetype {
+public:
+    static constexpr size_t chunkSize = 16 * 1024;
+
+    explicit Archetype(std::vector<const ComponentType*> types)
+        : _types(std::move(types))
+    {
+        size_t rowSize = sizeof(Entity);
+        _alignment = alignof(Entity);
+        for (const ComponentType* type : _types) {
+            rowSize += type->size;
+            _alignment = std::max(_alignment, type->alignment);
+        }
+
+        _capacity = std::max<size_t>(1, chunkSize / rowSize);
+        while (layout() > chunkSize && _capacity > 1) {
+            _capacity--;
+        }
+        _chunkBytes = layout();
+    }
+
+    Archetype(const Archetype&) = delete;
+    Archetype(Archetype&&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
+    Archetype& operator=(Archetype&&) = delete;
+
+    ~Archetype()
+    {
+        while (_size > 0) {
+            remove(_size - 1);
+        }
+    }
+
+    const std::vector<const ComponentType*>& types() const
+    {
+        return _types;
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    // Number of chunks holding at least one row. One spare chunk may be kept
+    // allocated past these to avoid churn at a chunk boundary.
+    size_t chunkCount() const
+    {
+        return (_size + _capacity - 1) / _capacity;
+    }
+
+    size_t chunkRows(size_t chunk) const
+    {
+        return std::min(_capacity, _size - chunk * _capacity);
+    }
+
+    // Index of the column holding the given type, or npos if absent.
+    size_t column(const ComponentType* type) const
+    {
+        for (size_t i = 0; i < _types.size(); i++) {
+            if (_types[i] == type) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    const Entity* entities(size_t chunk) const
+    {
+        return reinterpret_cast<const Entity*>(_chunks[chunk].get());
+    }
+
+    void* columnData(size_t chunk, size_t column) const
+    {
+        return _chunks[chunk].get() + _columnOffsets[column];
+    }
+
+    Entity entity(size_t row) const
+    {
+        return entities(row / _capacity)[row % _capacity];
+    }
+
+    void* component(size_t column, size_t row) const
+    {
+        return static_cast<std::byte*>(columnData(row / _capacity, column)) +
+            (row % _capacity) * _types[column]->size;
+    }
+
+    // Appends a row for the entity. Component columns of the new row are left
+    // uninitialized and must be constructed by the caller.
+    size_t push(Entity e)
+    {
+        if (_size == _chunks.size() * _capacity) {
+            _chunks.push_back(allocateChunk());
+        }
+        size_t row = _size++;
+        new (const_cast<Entity*>(entities(row / _capacity)) + row % _capacity)
+            Entity{e};
+        return row;
+    }
+
+    // Destroys the row and fills the hole with the last row. Returns the
+    // entity that was moved into the row, or a null entity if none was.
+    Entity remove(size_t row)
+    {
+        for (size_t c = 0; c < _types.size(); c++) {
+            _types[c]->destroy(component(c, row));
+        }
+
+        Entity moved;
+        size_t last = _size - 1;
+        if (row != last) {
+            for (size_t c = 0; c < _types.size(); c++) {
+                _types[c]->moveConstruct(component(c, row), component(c, last));
+                _types[c]->destroy(component(c, last));
+            }
+            moved = entity(last);
+            const_cast<Entity*>(entities(row / _capacity))[row % _capacity] =
+                moved;
+        }
+
+        _size--;
+        if (_chunks.size() > 1 && _size <= (_chunks.size() - 2) * _capacity) {
+            _chunks.pop_back();
+        }
+        return moved;
+    }
+
+    // Destroys the rows, which must be sorted and unique, and closes the gaps
+    // by moving the remaining rows down in order. Rows before the first
+    // removed one keep their position.
+    void removeRows(std::span<const size_t> rows)
+    {
+        if (rows.empty()) {
+            return;
+        }
+
+        size_t next = 0;
+        size_t kept = rows.front();
+        for (size_t row = rows.front(); row < _size; row++) {
+            if (next < rows.size() && rows[next] == row) {
+                for (size_t c = 0; c < _types.size(); c++) {
+                    _types[c]->destroy(component(c, row));
+                }
+                next++;
+                continue;
+            }
+            for (size_t c = 0; c < _types.size(); c++) {
+                _types[c]->moveConstruct(component(c, kept), component(c, row));
+                _types[c]->destroy(component(c, row));
+            }
+            const_cast<Entity*>(entities(kept / _capacity))[kept % _capacity] =
+                entity(row);
+            kept++;
+        }
+
+        _size = kept;
+        while (_chunks.size() > 1 &&
+            _size <= (_chunks.size() - 2) * _capacity) {
+            _chunks.pop_back();
+        }
+    }
+
+    Archetype* addEdge(const ComponentType* type) const
+    {
+        auto it = _addEdges.find(type);
+        return it != _addEdges.end() ? it->second : nullptr;
+    }
+
+    void setAddEdge(const ComponentType* type, Archetype* archetype)
+    {
+        _addEdges[type] = archetype;
+    }
+
+    Archetype* removeEdge(const ComponentType* type) const
+    {
+        auto it = _removeEdges.find(type);
+        return it != _removeEdges.end() ? it->second : nullptr;
+    }
+
+    void setRemoveEdge(const ComponentType* type, Archetype* archetype)
+    {
+        _removeEdges[type] = archetype;
+    }
+
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+private:
+    struct ChunkDeleter {
+        size_t alignment = 0;
+
+        void operator()(std::byte* ptr) const
+        {
+            ::operator delete[](ptr, std::align_val_t{alignment});
+        }
+    };
+
+    using Chunk = std::unique_ptr<std::byte[], ChunkDeleter>;
+
+    static size_t alignUp(size_t offset, size_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    size_t layout()
+    {
+        _columnOffsets.clear();
+        size_t offset = sizeof(Entity) * _capacity;
+        for (const ComponentType* type : _types) {
+            offset = alignUp(offset, type->alignment);
+            _columnOffsets.push_back(offset);
+            offset += type->size * _capacity;
+        }
+        return offset;
+    }
+
+    Chunk allocateChunk() const
+    {
+        auto* ptr = static_cast<std::byte*>(
+            ::operator new[](_chunkBytes, std::align_val_t{_alignment}));
+        return Chunk{ptr, ChunkDeleter{_alignment}};
+    }
+
+    std::vector<const ComponentType*> _types;
+    std::vector<size_t> _columnOffsets;
+    size_t _alignment = 0;
+    size_t _capacity = 0;
+    size_t _chunkBytes = 0;
+    size_t _size = 0;
+    std::vector<Chunk> _chunks;
+    std::unordered_map<const ComponentType*, Archetype*> _addEdges;
+    std::unordered_map<const ComponentType*, Archetype*> _removeEdges;
+};
+
+// Iterates every archetype that contains all of the requested components,
+// chunk by chunk, yielding (entity, components...) tuples of references.
+template <class... Components>
+class ArchetypeView {
+public:
+    using value_type = std::tuple<Entity, Components&...>;
+
+    struct Match {
+        Archetype* archetype = nullptr;
+        std::array<size_t, sizeof...(Components)> columns {};
+    };
+
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ArchetypeView::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type;
+        using pointer = void;
+
+        Iterator() = default;
+
+        Iterator(const std::vector<Match>* matches, size_t match)
+            : _matches(matches)
+            , _match(match)
+        {
+            skipEmpty();
+        }
+
+        reference operator*() const
+        {
+            const Match& match = (*_matches)[_match];
+            return get(match, std::index_sequence_for<Components...>{});
+        }
+
+        Iterator& operator++()
+        {
+            ++_row;
+            skipEmpty();
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs)
+        {
+            return lhs._match == rhs._match && lhs._row == rhs._row;
+        }
+
+    private:
+        template <size_t... Is>
+        value_type get(const Match& match, std::index_sequence<Is...>) const
+        {
+            return value_type{
+                match.archetype->entity(_row),
+                *static_cast<Components*>(
+                    match.archetype->component(match.columns[Is], _row))...};
+        }
+
+        void skipEmpty()
+        {
+            while (_match < _matches->size() &&
+                    _row >= (*_matches)[_match].archetype->size()) {
+                _match++;
+                _row = 0;
+            }
+        }
+
+        const std::vector<Match>* _matches = nullptr;
+        size_t _match = 0;
+        size_t _row = 0;
+    };
+
+    explicit ArchetypeView(std::vector<Match> matches)
+        : _matches(std::move(matches))
+    { }
+
+    Iterator begin() const
+    {
+        return Iterator{&_matches, 0};
+    }
+
+    Iterator end() const
+    {
+        return Iterator{&_matches, _matches.size()};
+    }
+
+    template <class F>
+    void each(F&& f) const
+    {
+        for (const Match& match : _matches) {
+            eachChunk(match, f, std::index_sequence_for<Components...>{});
+        }
+    }
+
+private:
+    template <class F, size_t... Is>
+    static void eachChunk(const Match& match, F& f, std::index_sequence<Is...>)
+    {
+        const Archetype& archetype = *match.archetype;
+        for (size_t chunk = 0; chunk < archetype.chunkCount(); chunk++) {
+            const Entity* entities = archetype.entities(chunk);
+            auto columns = std::tuple{
+                static_cast<Components*>(
+                    archetype.columnData(chunk, match.columns[Is]))...};
+            size_t rows = archetype.chunkRows(chunk);
+            for (size_t i = 0; i < rows; i++) {
+                f(entities[i], std::get<Is>(columns)[i]...);
+            }
+        }
+    }
+
+    std::vector<Match> _matches;
+};
+
+// Archetype-based alternative to ECS with the same entity and component
+// interface. Adding a component moves the entity to the archetype of its new
+// component set; views iterate matching chunks without per-entity lookups.
+// Single-type spans (components<C>(), entities<C>()) are not available since
+// a component type can be spread over several archetypes.
+class ArchetypeECS {
+public:
+    ArchetypeECS()
+    {
+        _root = archetype({});
+    }
+
+    template <class Component>
+    const Component& component(Entity e) const
+    {
+        return *static_cast<const Component*>(find<Component>(e));
+    }
+
+    template <class Component>
+    Component& component(Entity e)
+    {
+        return *static_cast<Component*>(find<Component>(e));
+    }
+
+    // The entity's archetype is its signature.
+    template <class Component>
+    bool has(Entity e) const
+    {
+        return alive(e) &&
+            _locations[e.index()].archetype->column(
+                ComponentType::of<Component>()) != Archetype::npos;
+    }
+
+    template <class Component>
+    Component& add(Entity e)
+    {
+        void* ptr = addUninitialized(e, ComponentType::of<Component>());
+        return *new (ptr) Component{};
+    }
+
+    template <class Component>
+    void add(Entity e, Component&& component)
+    {
+        void* ptr = addUninitialized(e, ComponentType::of<Component>());
+        new (ptr) Component{std::move(component)};
+    }
+
+    template <class Component, std::ranges::sized_range R>
+    void addRange(std::span<const Entity> entities, R&& components)
+    {
+        if (std::ranges::size(components) != entities.size()) {
+            throw std::invalid_argument{"ArchetypeECS::addRange: size mismatch"};
+        }
+        auto it = std::ranges::begin(components);
+        for (Entity e : entities) {
+            void* ptr = addUninitialized(e, ComponentType::of<Component>());
+            new (ptr) Component(*it++);
+        }
+    }
+
+    template <class Component>
+    void remove(Entity e)
+    {
+        remove(e, ComponentType::of<Component>());
+    }
+
+    template <class... Components>
+    requires (sizeof...(Components) > 0)
+    ArchetypeView<Components...> view()
+    {
+        auto types = std::array{
+            ComponentType::of<std::remove_const_t<Components>>()...};
+        auto matches = std::vector<typename ArchetypeView<Components...>::Match>{};
+        for (const auto& archetype : _archetypes) {
+            auto match = typename ArchetypeView<Components...>::Match{
+                .archetype = archetype.get()};
+            bool matched = true;
+            for (size_t i = 0; i < types.size() && matched; i++) {
+                match.columns[i] = archetype->column(types[i]);
+                matched = match.columns[i] != Archetype::npos;
+            }
+            if (matched) {
+                matches.push_back(match);
+            }
+        }
+        return ArchetypeView<Components...>{std::move(matches)};
+    }
+
+    Entity create()
+    {
+        Entity e = _entityPool.create();
+        if (e.index() >= _locations.size()) {
+            _locations.resize(e.index() + 1);
+        }
+        _locations[e.index()] = Location{_root, _root->push(e)};
+        return e;
+    }
+
+    std::vector<Entity> createMany(size_t count)
+    {
+        auto entities = std::vector<Entity>(count);
+        _entityPool.createMany(entities);
+        for (Entity e : entities) {
+            if (e.index() >= _locations.size()) {
+                _locations.resize(e.index() + 1);
+            }
+            _locations[e.index()] = Location{_root, _root->push(e)};
+        }
+        return entities;
+    }
+
+    bool alive(Entity e) const
+    {
+        return _entityPool.alive(e);
+    }
+
+    void kill(Entity e)
+    {
+        if (!alive(e)) {
+            return;
+        }
+
+        const Location& location = _locations[e.index()];
+        relocate(location.archetype->remove(location.row), location.row);
+        _entityPool.kill(e);
+    }
+
+    // Dead and duplicate entities are skipped. Rows are grouped by archetype
+    // and each archetype is compacted once; archetypes losing only a few rows
+    // swap-remove them from the highest row down instead.
+    void killMany(std::span<const Entity> entities)
+    {
+        auto locations = std::vector<Location>{};
+        for (Entity e : entities) {
+            if (alive(e)) {
+                locations.push_back(_locations[e.index()]);
+                _entityPool.kill(e);
+            }
+        }
+        auto byRow = [] (const Location& lhs, const Location& rhs) {
+            if (lhs.archetype != rhs.archetype) {
+                return std::less<>{}(lhs.archetype, rhs.archetype);
+            }
+            return lhs.row < rhs.row;
+        };
+        std::ranges::sort(locations, byRow);
+
+        auto rows = std::vector<size_t>{};
+        for (auto it = locations.begin(); it != locations.end();) {
+            Archetype* archetype = it->archetype;
+            rows.clear();
+            for (; it != locations.end() && it->archetype == archetype; it++) {
+                rows.push_back(it->row);
+            }
+
+            if (rows.size() * 8 < archetype->size()) {
+                for (size_t row : rows | std::views::reverse) {
+                    relocate(archetype->remove(row), row);
+                }
+                continue;
+            }
+            archetype->removeRows(rows);
+            for (size_t row = rows.front(); row < archetype->size(); row++) {
+                _locations[archetype->entity(row).index()].row = row;
+            }
+        }
+    }
+
+private:
+    struct Location {
+        Archetype* archetype = nullptr;
+        size_t row = 0;
+    };
+
+    template <class Component>
+    void* find(Entity e) const
+    {
+        if (!alive(e)) {
+            throw std::out_of_range{"ArchetypeECS::find"};
+        }
+        const Location& location = _locations[e.index()];
+        size_t column =
+            location.archetype->column(ComponentType::of<Component>());
+        if (column == Archetype::npos) {
+            throw std::out_of_range{"ArchetypeECS::find"};
+        }
+        return location.archetype->component(column, location.row);
+    }
+
+    void relocate(Entity moved, size_t row)
+    {
+        if (!moved.isNull()) {
+            _locations[moved.index()].row = row;
+        }
+    }
+
+    // Moves the entity to the archetype extended with the type and returns
+    // the uninitialized storage for the new component. If the entity already
+    // has the component, the old value is destroyed and its storage returned.
+    void* addUninitialized(Entity e, const ComponentType* type)
+    {
+        if (!alive(e)) {
+            throw std::out_of_range{"ArchetypeECS::add"};
+        }
+
+        Location& location = _locations[e.index()];
+        Archetype* source = location.archetype;
+        if (size_t column = source->column(type); column != Archetype::npos) {
+            void* ptr = source->component(column, location.row);
+            type->destroy(ptr);
+            return ptr;
+        }
+
+        Archetype* target = source->addEdge(type);
+        if (!target) {
+            auto types = source->types();
+            types.insert(
+                std::ranges::upper_bound(
+                    types, type->index, {}, &ComponentType::index),
+                type);
+            target = archetype(std::move(types));
+            source->setAddEdge(type, target);
+        }
+
+        migrate(location, target);
+        return location.archetype->component(
+            target->column(type), location.row);
+    }
+
+    void remove(Entity e, const ComponentType* type)
+    {
+        if (!alive(e)) {
+            return;
+        }
+
+        Location& location = _locations[e.index()];
+        Archetype* source = location.archetype;
+        if (source->column(type) == Archetype::npos) {
+            return;
+        }
+
+        Archetype* target = source->removeEdge(type);
+        if (!target) {
+            auto types = source->types();
+            std::erase(types, type);
+            target = archetype(std::move(types));
+            source->setRemoveEdge(type, target);
+        }
+
+        migrate(location, target);
+    }
+
+    // Moves the entity's row into the target archetype. Components present in
+    // both archetypes are moved, target columns missing from the source are
+    // left uninitialized, and source columns missing from the target are
+    // destroyed.
+    void migrate(Location& location, Archetype* target)
+    {
+        Archetype* source = location.archetype;
+        size_t row = target->push(source->entity(location.row));
+        for (size_t c = 0; c < target->types().size(); c++) {
+            const ComponentType* type = target->types()[c];
+            if (size_t column = source->column(type); column != Archetype::npos) {
+                type->moveConstruct(
+                    target->component(c, row),
+                    source->component(column, location.row));
+            }
+        }
+
+        relocate(source->remove(location.row), location.row);
+        location = Location{target, row};
+    }
+
+    Archetype* archetype(std::vector<const ComponentType*> types)
+    {
+        auto& archetype = _archetypeIndex[types];
+        if (!archetype) {
+            archetype = _archetypes.emplace_back(
+                std::make_unique<Archetype>(std::move(types))).get();
+        }
+        return archetype;
+    }
+
+    EntityPool _entityPool;
+    std::vector<Location> _locations;
+    std::vector<std::unique_ptr<Archetype>> _archetypes;
+    std::map<std::vector<const ComponentType*>, Archetype*> _archetypeIndex;
+    Archetype* _root = nullptr;
+};
@@ -0,0 +1,132 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// A pool without threads would never run the first system, and run() would
+// wait forever.
+size_t checkedThreadCount(size_t threadCount)
+{
+    if (threadCount == 0) {
+        throw std::invalid_argument{"Scheduler: thread count must be positive"};
+    }
+    return threadCount;
+}
+
+} // namespace
+
+Scheduler::Scheduler(size_t threadCount)
+    : _pool(checkedThreadCount(threadCount))
+{ }
+
+void Scheduler::run()
+{
+    if (_systems.empty()) {
+        return;
+    }
+
+    buildGraph();
+
+    {
+        auto lock = std::scoped_lock{_mutex};
+        _remaining = _systems.size();
+        _error = nullptr;
+        for (System& system : _systems) {
+            system.pendingDependencies = system.dependencyCount;
+        }
+    }
+
+    for (size_t i = 0; i < _systems.size(); i++) {
+        if (_systems[i].dependencyCount == 0) {
+            start(i);
+        }
+    }
+
+    auto lock = std::unique_lock{_mutex};
+    _done.wait(lock, [this] { return _remaining == 0; });
+    if (_error) {
+        std::rethrow_exception(_error);
+    }
+}
+
+const std::vector<SystemTiming>& Scheduler::timings() const
+{
+    return _timings;
+}
+
+bool Scheduler::conflict(const System& lhs, const System& rhs)
+{
+    auto touches = [] (const System& system, std::type_index type) {
+        return std::ranges::find(system.reads, type) != system.reads.end() ||
+            std::ranges::find(system.writes, type) != system.writes.end();
+    };
+
+    return std::ranges::any_of(lhs.writes, [&] (std::type_index type) {
+            return touches(rhs, type);
+        }) ||
+        std::ranges::any_of(rhs.writes, [&] (std::type_index type) {
+            return touches(lhs, type);
+        });
+}
+
+void Scheduler::addSystem(System system)
+{
+    _timings.push_back(SystemTiming{.name = system.name});
+    _systems.push_back(std::move(system));
+    _graphBuilt = false;
+}
+
+void Scheduler::buildGraph()
+{
+    if (_graphBuilt) {
+        return;
+    }
+
+    for (System& system : _systems) {
+        system.dependents.clear();
+        system.dependencyCount = 0;
+    }
+
+    for (size_t later = 0; later < _systems.size(); later++) {
+        for (size_t earlier = 0; earlier < later; earlier++) {
+            if (conflict(_systems[earlier], _systems[later])) {
+                _systems[earlier].dependents.push_back(later);
+                _systems[later].dependencyCount++;
+            }
+        }
+    }
+
+    _graphBuilt = true;
+}
+
+void Scheduler::start(size_t index)
+{
+    _pool.submit([this, index] {
+        auto start = std::chrono::steady_clock::now();
+        try {
+            _systems[index].function();
+        } catch (...) {
+            auto lock = std::scoped_lock{_mutex};
+            if (!_error) {
+                _error = std::current_exception();
+            }
+        }
+        _timings[index].duration = std::chrono::steady_clock::now() - start;
+        finish(index);
+    });
+}
+
+void Scheduler::finish(size_t index)
+{
+    auto lock = std::scoped_lock{_mutex};
+    for (size_t dependent : _systems[index].dependents) {
+        if (--_systems[dependent].pendingDependencies == 0) {
+            start(dependent);
+        }
+    }
+    if (--_remaining == 0) {
+        _done.notify_one();
+    }
+}
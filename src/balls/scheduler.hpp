@@ -0,0 +1,87 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <vector>
+
+template <class... Components>
+struct Reads {};
+
+template <class... Components>
+struct Writes {};
+
+struct SystemTiming {
+    std::string name;
+    std::chrono::nanoseconds duration {};
+};
+
+// Runs systems on a worker pool. Each system declares the component types it
+// reads and writes; two systems conflict if one writes a type the other
+// touches, and conflicting systems run in the order they were added. All
+// other systems may run concurrently.
+class Scheduler {
+public:
+    // Throws std::invalid_argument for 0 threads.
+    explicit Scheduler(
+        size_t threadCount = std::max(1u, std::thread::hardware_concurrency()));
+
+    template <class... ReadComponents, class... WriteComponents>
+    void add(
+        std::string name,
+        Reads<ReadComponents...>,
+        Writes<WriteComponents...>,
+        std::function<void()> system)
+    {
+        addSystem(System{
+            .name = std::move(name),
+            .reads = {typeid(ReadComponents)...},
+            .writes = {typeid(WriteComponents)...},
+            .function = std::move(system),
+        });
+    }
+
+    // Runs every system once and waits for all of them to finish. The first
+    // exception thrown by a system is rethrown here.
+    void run();
+
+    const std::vector<SystemTiming>& timings() const;
+
+private:
+    struct System {
+        std::string name;
+        std::vector<std::type_index> reads;
+        std::vector<std::type_index> writes;
+        std::function<void()> function;
+        std::vector<size_t> dependents {};
+        size_t dependencyCount = 0;
+        size_t pendingDependencies = 0;
+    };
+
+    static bool conflict(const System& lhs, const System& rhs);
+
+    void addSystem(System system);
+    void buildGraph();
+    void start(size_t index);
+    void finish(size_t index);
+
+    std::vector<System> _systems;
+    std::vector<SystemTiming> _timings;
+    bool _graphBuilt = false;
+
+    std::mutex _mutex;
+    std::condition_variable _done;
+    size_t _remaining = 0;
+    std::exception_ptr _error;
+
+    ThreadPool _pool;
+};
@@ -47,19 +47,19 @@ void View::render()
 
     _renderer.setDrawColor(200, 200, 200, 255);
     _renderer.fillRect(SDL_FRect{
-        .x = _world.pad().minX(),
-        .y = _world.pad().minY(),
-        .w = _world.pad().width,
-        .h = _world.pad().height,
+        .x = toFloat(_world.pad().minX()),
+        .y = toFloat(_world.pad().minY()),
+        .w = toFloat(_world.pad().width),
+        .h = toFloat(_world.pad().height),
     });
 
     _renderer.setDrawColor(200, 100, 100, 255);
     for (const auto& brick : _world.bricks()) {
         _renderer.fillRect(SDL_FRect{
-            .x = brick.minX(),
-            .y = brick.minY(),
-            .w = brick.width,
-            .h = brick.height,
+            .x = toFloat(brick.minX()),
+            .y = toFloat(brick.minY()),
+            .w = toFloat(brick.width),
+            .h = toFloat(brick.height),
         });
     }
 
@@ -1,44 +1,71 @@
 #include "world.hpp"
 
-#include "collision.hpp"
-#include "distance.hpp"
+#include "config.hpp"
 
 #include <iostream>
+#include <vector>
+
+namespace {
+
+// Bounces per update; the rest of the movement is dropped after that, so a
+// ball wedged between bricks cannot stall the frame.
+constexpr int maxBounces = 8;
+
+// Hits closer than this along the movement are at the body's current
+// position, where only an approach towards the brick counts as a collision.
+constexpr float contactTolerance = 1e-3f;
+
+bool approaches(
+    const Point& point, const Vector& direction, const AxisAlignedRect& rect)
+{
+    return signedDistance(point + direction * contactTolerance, rect) <
+        signedDistance(point, rect);
+}
+
+} // namespace
 
 World::World()
-    : _ball{
+    : _bricks{
+        AxisAlignedRect{
+            .center = Point{config.windowWidth / 2.f, config.windowHeight / 2.f},
+            .width = static_cast<float>(config.windowWidth),
+            .height = static_cast<float>(config.windowHeight),
+        },
+        8,
+        64,
+    }
+    , _ball{
         .body = Circle{.center = Point{10, 3}, .radius = 1},
         .velocity = Vector{1, 3}
     }
     , _pad{{200, 50}, 100, 50}
 {
-    _bricks.push_back(AxisAlignedRect{{500, 400}, 100, 50});
-    _bricks.push_back(AxisAlignedRect{{300, 100}, 100, 50});
+    _bricks.add(AxisAlignedRect{{500, 400}, 100, 50});
+    _bricks.add(AxisAlignedRect{{300, 100}, 100, 50});
 }
 
 void World::update(float delta)
 {
     std::cerr << "pad position: " << _pad << "\n";
 
-    (void)delta;
-    // this is definitely stupid!
-    //float distanceToMove = _ball.velocity.length() * delta;
-    //while (distanceToMove > 0) {
-    //    auto collisions = std::vector<std::optional<Collision>>{};
-    //    for (const auto& brick : _bricks) {
-    //        collisions.push_back(collide(_ball.body, _ball.velocity, brick));
-    //    }
-
-    //    auto best = bestCollision(_ball.body.center, collisions);
-    //    if (!best) {
-    //        _ball.body.center += _ball.velocity * delta;
-    //        break;
-    //    }
+    // Moves the ball by velocity * delta, bouncing off the bricks on the way;
+    // each bounce uses up the distance travelled to it.
+    Scalar speed = _ball.velocity.length();
+    Scalar remaining = speed * delta;
+    for (int bounce = 0; bounce < maxBounces && remaining > 0; bounce++) {
+        Vector movement = _ball.velocity * (remaining / speed);
+        auto hit = collideBricks(_ball.body, movement);
+        if (!hit) {
+            _ball.body.center += movement;
+            break;
+        }
 
-    //    distanceToMove -= distance(_ball.body.center, best->position);
-    //    _ball.body.center = best->position;
-    //    _ball.velocity = best->movement;
-    //}
+        // The reflected movement has the length of the movement; scale it
+        // back to the ball's speed.
+        _ball.velocity = hit->movement * (speed / remaining);
+        remaining -= distance(_ball.body.center, hit->position);
+        _ball.body.center = hit->position;
+    }
 }
 
 void World::setControl(float padPosition)
@@ -46,12 +73,56 @@ void World::setControl(float padPosition)
     _pad.center.x = padPosition;
 }
 
+void World::save(SnapshotWriter& writer) const
+{
+    writer.writeRange(_bricks.rects());
+    writer.write(_ball);
+    writer.write(_pad);
+}
+
+void World::load(SnapshotReader& reader)
+{
+    auto bricks = std::vector<AxisAlignedRect>{};
+    reader.readRange(bricks);
+    _bricks.assign(bricks);
+    reader.read(_ball);
+    reader.read(_pad);
+}
+
 std::span<const AxisAlignedRect> World::bricks() const
 {
-    return _bricks;
+    return _bricks.rects();
 }
 
 const AxisAlignedRect& World::pad() const
 {
     return _pad;
 }
+
+std::optional<Collision> World::collideBricks(
+    const Circle& body, const Vector& movement) const
+{
+    Scalar length = movement.length();
+    if (_bricks.safeTravel(body, movement) >= length) {
+        return std::nullopt;
+    }
+
+    // collide() tests the whole line of the movement, so only hits between
+    // its start and its end count. A hit at the start is either a brick the
+    // body has just reached or, after a bounce, one it is leaving.
+    Vector direction = movement / length;
+    auto collisions = std::vector<std::optional<Collision>>{};
+    for (const auto& brick : _bricks.rects()) {
+        auto collision = collide(body, movement, brick);
+        if (!collision) {
+            continue;
+        }
+        Scalar along = dot(collision->position - body.center, direction);
+        bool ahead = along > contactTolerance ||
+            (along > -contactTolerance && approaches(body.center, direction, brick));
+        if (ahead && along <= length) {
+            collisions.push_back(collision);
+        }
+    }
+    return bestCollision(body.center, collisions);
+}
@@ -1,15 +1,26 @@
 #pragma once
 
+#include "collision.hpp"
+#include "distance.hpp"
 #include "ecs.hpp"
 #include "geometry.hpp"
+#include "snapshot.hpp"
 
-#include <vector>
+#include <optional>
+#include <type_traits>
 
 struct Movement {
     Point position;
     Vector velocity;
 };
 
+// Lanes of a SoaVector are float, so fixed-point builds keep Movement whole.
+template <>
+struct ComponentTraits<Movement> : DefaultComponentTraits {
+    static constexpr ComponentLayout layout = std::is_same_v<Scalar, float> ?
+        ComponentLayout::StructOfArrays : ComponentLayout::Contiguous;
+};
+
 struct Ball {
     Circle body;
     Vector velocity;
@@ -22,11 +33,20 @@ public:
     void update(float delta);
     void setControl(float padPosition);
 
+    void save(SnapshotWriter& writer) const;
+    void load(SnapshotReader& reader);
+
     std::span<const AxisAlignedRect> bricks() const;
     const AxisAlignedRect& pad() const;
 
+    // Closest collision of the body with a brick between the start and the
+    // end of the movement. The bricks' distance grid answers most calls;
+    // exact collision is only computed when it cannot prove the movement free.
+    std::optional<Collision> collideBricks(
+        const Circle& body, const Vector& movement) const;
+
 private:
-    std::vector<AxisAlignedRect> _bricks;
+    DistanceGrid _bricks;
     Ball _ball;
     AxisAlignedRect _pad;
 };
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> liveBytes = 0;
+
+const void* volatile sink = nullptr;
+
+// Every block is preceded by a header that remembers the malloc'ed address
+// and the requested size, so deallocation can update the count without
+// relying on sized delete.
+struct Header {
+    void* base;
+    size_t size;
+};
+
+void* allocate(size_t size, size_t alignment)
+{
+    alignment = std::max(alignment, alignof(std::max_align_t));
+    void* base = std::malloc(size + sizeof(Header) + alignment);
+    if (!base) {
+        throw std::bad_alloc{};
+    }
+
+    auto address = reinterpret_cast<uintptr_t>(base) + sizeof(Header);
+    address = (address + alignment - 1) / alignment * alignment;
+    auto ptr = reinterpret_cast<void*>(address);
+    static_cast<Header*>(ptr)[-1] = Header{base, size};
+
+    liveBytes += size;
+    return ptr;
+}
+
+void deallocate(void* ptr) noexcept
+{
+    if (!ptr) {
+        return;
+    }
+    Header header = static_cast<Header*>(ptr)[-1];
+    liveBytes -= header.size;
+    std::free(header.base);
+}
+
+void writeString(std::ostream& output, std::string_view string)
+{
+    output << '"';
+    for (char c : string) {
+        if (c == '"' || c == '\\') {
+            output << '\\';
+        }
+        output << c;
+    }
+    output << '"';
+}
+
+// JSON has no NaN or infinity, so those become null. Finite values are
+// written with enough digits to read back the same double.
+void writeNumber(std::ostream& output, double value)
+{
+    if (!std::isfinite(value)) {
+        output << "null";
+        return;
+    }
+    std::streamsize precision = output.precision();
+    output << std::setprecision(std::numeric_limits<double>::max_digits10)
+        << value << std::setprecision(precision);
+}
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size)
+{
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept
+{
+    deallocate(ptr);
+}
+
+size_t liveHeapBytes()
+{
+    return liveBytes;
+}
+
+void doNotOptimize(const void* value)
+{
+    sink = value;
+}
+
+void writeJson(
+    std::ostream& output,
+    std::string_view benchmark,
+    const std::vector<BenchResult>& results)
+{
+    output << "{\n  \"benchmark\": ";
+    writeString(output, benchmark);
+    output << ",\n  \"results\": [";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        output << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        writeString(output, result.name);
+        for (const auto& [key, value] : result.tags) {
+            output << ", ";
+            writeString(output, key);
+            output << ": ";
+            writeString(output, value);
+        }
+        for (const auto& [key, value] : result.values) {
+            output << ", ";
+            writeString(output, key);
+            output << ": ";
+            writeNumber(output, value);
+        }
+        output << "}";
+    }
+
+    output << "\n  ]\n}\n";
+}
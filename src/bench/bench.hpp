@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// One measurement: a name, descriptive tags (backend, entity count, ...) and
+// numeric values (ns_per_op, bytes_per_entity, ...).
+struct BenchResult {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> tags;
+    std::vector<std::pair<std::string, double>> values;
+};
+
+// Bytes currently allocated through operator new. bench.cpp replaces the
+// global allocation functions to keep this count.
+size_t liveHeapBytes();
+
+// Keeps the compiler from discarding a computed value.
+void doNotOptimize(const void* value);
+
+// Calls run() until at least minDuration has passed and returns the average
+// time per operation, where each call performs opsPerRun operations.
+template <class F>
+double nsPerOp(
+    size_t opsPerRun,
+    F&& run,
+    std::chrono::nanoseconds minDuration = std::chrono::milliseconds{200})
+{
+    using Clock = std::chrono::steady_clock;
+
+    size_t runs = 0;
+    auto start = Clock::now();
+    auto elapsed = Clock::duration{};
+    do {
+        run();
+        runs++;
+        elapsed = Clock::now() - start;
+    } while (elapsed < minDuration);
+
+    auto ns = std::chrono::duration<double, std::nano>{elapsed}.count();
+    return ns / static_cast<double>(runs * opsPerRun);
+}
+
+// Writes {"benchmark": name, "results": [...]} with one object per result
+// holding its name, tags and values as flat fields.
+void writeJson(
+    std::ostream& output,
+    std::string_view benchmark,
+    const std::vector<BenchResult>& results);
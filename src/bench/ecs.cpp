@@ -0,0 +1,204 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Position {
+    float x = 0.f;
+    float y = 0.f;
+};
+
+struct Velocity {
+    float x = 0.f;
+    float y = 0.f;
+};
+
+struct Health {
+    int value = 0;
+};
+
+// Registry with n entities. Every entity has a Position, every second one a
+// Velocity and every fourth one a Health. bytesPerEntity is the heap growth
+// caused by building the registry.
+template <class Registry>
+struct Fixture {
+    explicit Fixture(size_t count)
+    {
+        entities.reserve(count);
+        size_t before = liveHeapBytes();
+        registry = std::make_unique<Registry>();
+        for (size_t i = 0; i < count; i++) {
+            entities.push_back(spawn(i));
+        }
+        bytesPerEntity =
+            static_cast<double>(liveHeapBytes() - before) / static_cast<double>(count);
+    }
+
+    Entity spawn(size_t i)
+    {
+        Entity e = registry->create();
+        registry->template add<Position>(e, Position{static_cast<float>(i), 0.f});
+        if (i % 2 == 0) {
+            registry->template add<Velocity>(e, Velocity{1.f, 1.f});
+        }
+        if (i % 4 == 0) {
+            registry->template add<Health>(e, Health{100});
+        }
+        return e;
+    }
+
+    std::vector<size_t> shuffledIndices() const
+    {
+        auto indices = std::vector<size_t>(entities.size());
+        for (size_t i = 0; i < indices.size(); i++) {
+            indices[i] = i;
+        }
+        std::ranges::shuffle(indices, std::mt19937{42});
+        return indices;
+    }
+
+    std::unique_ptr<Registry> registry;
+    std::vector<Entity> entities;
+    double bytesPerEntity = 0.;
+};
+
+// Kill every entity, then create all of them again with their components.
+template <class Registry>
+double churn(Fixture<Registry>& fixture)
+{
+    size_t count = fixture.entities.size();
+    return nsPerOp(count, [&fixture, count] {
+        for (Entity e : fixture.entities) {
+            fixture.registry->kill(e);
+        }
+        for (size_t i = 0; i < count; i++) {
+            fixture.entities[i] = fixture.spawn(i);
+        }
+    });
+}
+
+// component<Position>(e) for every entity in random order.
+template <class Registry>
+double lookup(Fixture<Registry>& fixture)
+{
+    auto order = fixture.shuffledIndices();
+    return nsPerOp(order.size(), [&fixture, &order] {
+        float sum = 0.f;
+        for (size_t i : order) {
+            Position position =
+                fixture.registry->template component<Position>(fixture.entities[i]);
+            sum += position.x;
+        }
+        doNotOptimize(&sum);
+    });
+}
+
+// Reads every Position through the single-type span. Archetype registries
+// have no such span and iterate a one-component view instead.
+template <class Registry>
+double iterate(Fixture<Registry>& fixture)
+{
+    Registry& registry = *fixture.registry;
+    return nsPerOp(fixture.entities.size(), [&registry] {
+        float sum = 0.f;
+        if constexpr (requires { registry.template components<Position>(); }) {
+            for (const Position& position : registry.template components<Position>()) {
+                sum += position.x;
+            }
+        } else {
+            registry.template view<const Position>().each(
+                [&sum] (Entity, const Position& position) { sum += position.x; });
+        }
+        doNotOptimize(&sum);
+    });
+}
+
+// Joins Position and Velocity, which half of the entities have.
+template <class Registry>
+double join(Fixture<Registry>& fixture)
+{
+    Registry& registry = *fixture.registry;
+    size_t matches = (fixture.entities.size() + 1) / 2;
+    return nsPerOp(matches, [&registry] {
+        float sum = 0.f;
+        registry.template view<const Position, const Velocity>().each(
+            [&sum] (Entity, const Position& position, const Velocity& velocity) {
+                sum += position.x * velocity.x;
+            });
+        doNotOptimize(&sum);
+    });
+}
+
+// Kills one entity and immediately creates another, which reuses the freed
+// slot under a new generation. Slots are hit in random order, so the free
+// list and the storages' sparse indices never see a sequential pattern.
+template <class Registry>
+double recycle(Fixture<Registry>& fixture)
+{
+    auto order = fixture.shuffledIndices();
+    return nsPerOp(order.size(), [&fixture, &order] {
+        for (size_t i : order) {
+            fixture.registry->kill(fixture.entities[i]);
+            fixture.entities[i] = fixture.spawn(i);
+        }
+    });
+}
+
+template <class Registry>
+void run(
+    std::string_view backend, size_t count, std::vector<BenchResult>& results)
+{
+    struct Scenario {
+        const char* name;
+        double (*run)(Fixture<Registry>&);
+    };
+    const Scenario scenarios[] = {
+        {"churn", churn<Registry>},
+        {"lookup", lookup<Registry>},
+        {"iterate", iterate<Registry>},
+        {"join", join<Registry>},
+        {"recycle", recycle<Registry>},
+    };
+
+    for (const Scenario& scenario : scenarios) {
+        auto fixture = Fixture<Registry>{count};
+        double ns = scenario.run(fixture);
+        results.push_back(BenchResult{
+            .name = scenario.name,
+            .tags = {{"backend", std::string{backend}}},
+            .values = {
+                {"entities", static_cast<double>(count)},
+                {"ns_per_op", ns},
+                {"bytes_per_entity", fixture.bytesPerEntity},
+            },
+        });
+        std::cerr << backend << " " << scenario.name << " " << count << ": "
+            << ns << " ns/op\n";
+    }
+}
+
+} // namespace
+
+// Usage: ecs-bench [max-entities]. Results go to stdout as JSON, progress to
+// stderr.
+int main(int argc, char* argv[])
+{
+    size_t maxCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+
+    auto results = std::vector<BenchResult>{};
+    for (size_t count = 1'000; count <= maxCount; count *= 10) {
+        run<ECS>("ECS", count, results);
+        run<StaticECS<Position, Velocity, Health>>("StaticECS", count, results);
+        run<ArchetypeECS>("ArchetypeECS", count, results);
+    }
+
+    writeJson(std::cout, "ecs", results);
+}
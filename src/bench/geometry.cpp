@@ -0,0 +1,656 @@
+#include "bench.hpp"
+#include "collision.hpp"
+#include "distance.hpp"
+#include "intersection.hpp"
+#include "outline.hpp"
+#include "packet.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Queries per measured run; small enough to stay in L1.
+constexpr size_t inputCount = 4096;
+
+// Hit ratios for queries with a hit/miss outcome. Inputs are sampled until
+// they hit or miss as wanted, so an unreachable ratio is reported instead of
+// hanging.
+constexpr double hitRatios[] = {0., 0.5, 1.};
+constexpr size_t maxAttempts = 1'000'000;
+
+const char* scalarName()
+{
+    if constexpr (std::is_same_v<Scalar, float>) {
+        return "float";
+    } else if constexpr (sizeof(Scalar) == 4) {
+        return "q16.16";
+    } else {
+        return "q32.32";
+    }
+}
+
+// Random geometry in [-10, 10]^2. Sizes are in [0.5, 3], so hits and misses
+// are both common for every query.
+class Generator {
+public:
+    explicit Generator(uint32_t seed)
+        : _rng(seed)
+    { }
+
+    bool chance(double probability)
+    {
+        return std::bernoulli_distribution{probability}(_rng);
+    }
+
+    Scalar coordinate()
+    {
+        return std::uniform_real_distribution<float>{-10.f, 10.f}(_rng);
+    }
+
+    Scalar size()
+    {
+        return std::uniform_real_distribution<float>{0.5f, 3.f}(_rng);
+    }
+
+    Point point()
+    {
+        return Point{coordinate(), coordinate()};
+    }
+
+    Vector vector()
+    {
+        return Vector{coordinate(), coordinate()};
+    }
+
+    Circle circle()
+    {
+        return Circle{point(), size()};
+    }
+
+    Line line()
+    {
+        return Line{point(), vector()};
+    }
+
+    Ray ray()
+    {
+        return Ray{point(), vector()};
+    }
+
+    Segment segment()
+    {
+        return Segment{point(), point()};
+    }
+
+    AxisAlignedRect rect()
+    {
+        return AxisAlignedRect{point(), 2 * size(), 2 * size()};
+    }
+
+private:
+    std::mt19937 _rng;
+};
+
+template <class F>
+auto retry(F make)
+{
+    for (size_t attempt = 0; attempt < maxAttempts; attempt++) {
+        if (auto value = make()) {
+            return *value;
+        }
+    }
+    throw std::runtime_error{"hit ratio not reachable"};
+}
+
+// Folds a query result into the running sum that keeps it alive.
+Scalar digest(bool hit)
+{
+    return hit ? Scalar{1} : Scalar{0};
+}
+
+Scalar digest(Scalar value)
+{
+    return value;
+}
+
+template <class T>
+Scalar digest(const std::optional<T>& result)
+{
+    return digest(result.has_value());
+}
+
+template <size_t N>
+Scalar digest(const PointHits<N>& hits)
+{
+    return static_cast<Scalar>(hits.mask);
+}
+
+template <size_t N>
+Scalar digest(const CollisionPacket<N>& collisions)
+{
+    return static_cast<Scalar>(collisions.mask);
+}
+
+bool isHit(bool hit)
+{
+    return hit;
+}
+
+template <class T>
+bool isHit(const std::optional<T>& result)
+{
+    return result.has_value();
+}
+
+// Times query over the inputs; queriesPerInput > 1 for packets.
+template <class Input, class Query>
+BenchResult timeQueries(
+    std::string name,
+    const std::vector<Input>& inputs,
+    Query query,
+    size_t queriesPerInput = 1)
+{
+    size_t queries = inputs.size() * queriesPerInput;
+    double ns = nsPerOp(queries, [&inputs, &query] {
+        Scalar sum = 0;
+        for (const Input& input : inputs) {
+            sum += digest(std::apply(query, input));
+        }
+        doNotOptimize(&sum);
+    });
+
+    std::cerr << name << ": " << ns << " ns/query\n";
+    return BenchResult{
+        .name = std::move(name),
+        .tags = {{"scalar", scalarName()}},
+        .values = {
+            {"queries", static_cast<double>(queries)},
+            {"ns_per_query", ns},
+            {"queries_per_second", 1e9 / ns},
+        },
+    };
+}
+
+class Suite {
+public:
+    explicit Suite(uint32_t seed)
+        : _generator(seed)
+    { }
+
+    Generator& generator()
+    {
+        return _generator;
+    }
+
+    const std::vector<BenchResult>& results() const
+    {
+        return _results;
+    }
+
+    // Query without a hit/miss outcome, e.g. a distance.
+    template <class Make, class Query>
+    void measure(std::string name, Make make, Query query)
+    {
+        auto inputs = std::vector<decltype(make())>{};
+        for (size_t i = 0; i < inputCount; i++) {
+            inputs.push_back(make());
+        }
+        _results.push_back(timeQueries(std::move(name), inputs, query));
+    }
+
+    // Query whose result says hit or miss, run at every hit ratio.
+    template <class Make, class Query>
+    void measureHits(std::string name, Make make, Query query)
+    {
+        measureHits(std::move(name), make, query, [&query] (const auto& input) {
+            return isHit(std::apply(query, input));
+        });
+    }
+
+    // Same with an explicit hit test on the input.
+    template <class Make, class Query, class Hit>
+    void measureHits(std::string name, Make make, Query query, Hit hit)
+    {
+        using Input = decltype(make());
+        for (double ratio : hitRatios) {
+            auto inputs = std::vector<Input>{};
+            try {
+                for (size_t i = 0; i < inputCount; i++) {
+                    bool wantHit = _generator.chance(ratio);
+                    inputs.push_back(retry([&] {
+                        Input input = make();
+                        return hit(input) == wantHit ?
+                            std::optional{input} : std::nullopt;
+                    }));
+                }
+            } catch (const std::runtime_error&) {
+                std::cerr << name << ": hit ratio " << ratio << " not reachable\n";
+                continue;
+            }
+
+            size_t hits = 0;
+            for (const Input& input : inputs) {
+                hits += hit(input);
+            }
+            addHitResult(
+                timeQueries(name, inputs, query), ratio,
+                static_cast<double>(hits) / static_cast<double>(inputs.size()));
+        }
+    }
+
+    // Packet query: makePacket(wanted) returns a packet whose lane i hits
+    // exactly if bit i of wanted is set.
+    template <size_t N, class MakePacket, class Query>
+    void measurePackets(std::string name, MakePacket makePacket, Query query)
+    {
+        using Input = decltype(makePacket(HitMask{}));
+        for (double ratio : hitRatios) {
+            auto inputs = std::vector<Input>{};
+            size_t hits = 0;
+            try {
+                for (size_t i = 0; i < inputCount / N; i++) {
+                    HitMask wanted = 0;
+                    for (size_t lane = 0; lane < N; lane++) {
+                        wanted |= HitMask{_generator.chance(ratio)} << lane;
+                    }
+                    inputs.push_back(makePacket(wanted));
+                    hits += static_cast<size_t>(std::popcount(wanted));
+                }
+            } catch (const std::runtime_error&) {
+                std::cerr << name << ": hit ratio " << ratio << " not reachable\n";
+                continue;
+            }
+
+            addHitResult(
+                timeQueries(name, inputs, query, N), ratio,
+                static_cast<double>(hits) / static_cast<double>(inputs.size() * N));
+        }
+    }
+
+private:
+    void addHitResult(BenchResult result, double ratio, double measuredRatio)
+    {
+        auto ratioTag = std::ostringstream{};
+        ratioTag << ratio;
+        result.tags.emplace_back("hit_ratio", ratioTag.str());
+        result.values.emplace_back("measured_hit_ratio", measuredRatio);
+        _results.push_back(std::move(result));
+    }
+
+    Generator _generator;
+    std::vector<BenchResult> _results;
+};
+
+// The header-inline Vector/Point core. The last two cases are the per-ball
+// kernel of the inlining change, inline and through out-of-line calls.
+// Configure with BALLS_IPO OFF and ON to see the out-of-line kernel without
+// and with link-time optimization.
+void benchVector(Suite& suite)
+{
+    Generator& gen = suite.generator();
+
+    suite.measure(
+        "dot(Vector, Vector)",
+        [&] { return std::tuple{gen.vector(), gen.vector()}; },
+        [] (const Vector& a, const Vector& b) { return dot(a, b); });
+    suite.measure(
+        "cross(Vector, Vector)",
+        [&] { return std::tuple{gen.vector(), gen.vector()}; },
+        [] (const Vector& a, const Vector& b) { return cross(a, b); });
+    suite.measure(
+        "Vector::length()",
+        [&] { return std::tuple{gen.vector()}; },
+        [] (const Vector& v) { return v.length(); });
+    suite.measure(
+        "Vector::normalize()",
+        [&] { return std::tuple{gen.vector()}; },
+        [] (Vector v) {
+            v.normalize();
+            return v.x;
+        });
+    suite.measure(
+        "Vector::normalizeApprox()",
+        [&] { return std::tuple{gen.vector()}; },
+        [] (Vector v) {
+            v.normalizeApprox();
+            return v.x;
+        });
+    suite.measure(
+        "mirror(Vector, Norm)",
+        [&] { return std::tuple{gen.vector(), gen.vector().normalized()}; },
+        [] (const Vector& v, const Norm& n) { return mirror(v, n).x; });
+    suite.measure(
+        "AxisAlignedRect::segments()",
+        [&] { return std::tuple{gen.rect()}; },
+        [] (const AxisAlignedRect& r) { return r.segments()[2].start().x; });
+
+    // Moves a ball, bounces it off the walls of the generator's area and
+    // measures its distance to the origin.
+    suite.measure(
+        "ball step (move, reflect, distance)",
+        [&] { return std::tuple{gen.point(), gen.vector()}; },
+        [] (Point center, Vector velocity) {
+            center += velocity * Scalar{0.1f};
+            if (center.x < -10 || center.x > 10) {
+                velocity = mirror(velocity, Norm::fromUnit(Vector{1, 0}));
+            }
+            if (center.y < -10 || center.y > 10) {
+                velocity = mirror(velocity, Norm::fromUnit(Vector{0, 1}));
+            }
+            return (center - Point{0, 0}).length() + velocity.x;
+        });
+
+    // The same kernel through outline.hpp: the baseline for the inline core.
+    suite.measure(
+        "ball step, out-of-line ops",
+        [&] { return std::tuple{gen.point(), gen.vector()}; },
+        [] (Point center, Vector velocity) {
+            center = outline::translated(
+                center, outline::scaled(velocity, Scalar{0.1f}));
+            if (center.x < -10 || center.x > 10) {
+                velocity = outline::mirrored(velocity, Norm::fromUnit(Vector{1, 0}));
+            }
+            if (center.y < -10 || center.y > 10) {
+                velocity = outline::mirrored(velocity, Norm::fromUnit(Vector{0, 1}));
+            }
+            return outline::length(outline::difference(center, Point{0, 0})) +
+                velocity.x;
+        });
+}
+
+void benchCollide(Suite& suite)
+{
+    Generator& gen = suite.generator();
+
+    // Lines are only missed when parallel to the movement, which random
+    // input never is; every other such input gets a parallel line.
+    auto movementAndLine = [&gen] {
+        Vector movement = gen.vector();
+        Line line = gen.chance(0.5) ? Line{gen.point(), movement} : gen.line();
+        return std::tuple{movement, line};
+    };
+
+    suite.measureHits(
+        "collide(Point, Vector, Line)",
+        [&] { return std::tuple_cat(std::tuple{gen.point()}, movementAndLine()); },
+        [] (const Point& p, const Vector& m, const Line& l) { return collide(p, m, l); });
+    suite.measureHits(
+        "collide(Point, Vector, Circle)",
+        [&] { return std::tuple{gen.point(), gen.vector(), gen.circle()}; },
+        [] (const Point& p, const Vector& m, const Circle& c) { return collide(p, m, c); });
+    suite.measureHits(
+        "collide(Point, Vector, Segment)",
+        [&] { return std::tuple{gen.point(), gen.vector(), gen.segment()}; },
+        [] (const Point& p, const Vector& m, const Segment& s) { return collide(p, m, s); });
+    suite.measureHits(
+        "collide(Circle, Vector, Point)",
+        [&] { return std::tuple{gen.circle(), gen.vector(), gen.point()}; },
+        [] (const Circle& c, const Vector& m, const Point& p) { return collide(c, m, p); });
+    suite.measureHits(
+        "collide(Circle, Vector, Line)",
+        [&] { return std::tuple_cat(std::tuple{gen.circle()}, movementAndLine()); },
+        [] (const Circle& c, const Vector& m, const Line& l) { return collide(c, m, l); });
+    suite.measureHits(
+        "collide(Circle, Vector, Segment)",
+        [&] { return std::tuple{gen.circle(), gen.vector(), gen.segment()}; },
+        [] (const Circle& c, const Vector& m, const Segment& s) { return collide(c, m, s); });
+    suite.measureHits(
+        "collide(Circle, Vector, AxisAlignedRect)",
+        [&] { return std::tuple{gen.circle(), gen.vector(), gen.rect()}; },
+        [] (const Circle& c, const Vector& m, const AxisAlignedRect& r) {
+            return collide(c, m, r);
+        });
+}
+
+template <size_t N>
+void benchCollidePacket(Suite& suite)
+{
+    Generator& gen = suite.generator();
+
+    suite.measurePackets<N>(
+        "collide(CirclePacket<" + std::to_string(N) + ">, VectorPacket, Segment)",
+        [&gen] (HitMask wanted) {
+            Segment segment = gen.segment();
+            auto circles = CirclePacket<N>{};
+            auto movements = VectorPacket<N>{};
+            for (size_t lane = 0; lane < N; lane++) {
+                auto [circle, movement] = retry([&] {
+                    Circle c = gen.circle();
+                    Vector m = gen.vector();
+                    bool hit = collide(c, m, segment).has_value();
+                    return hit == laneHit(wanted, lane) ?
+                        std::optional{std::pair{c, m}} : std::nullopt;
+                });
+                circles.set(lane, circle);
+                movements.set(lane, movement);
+            }
+            return std::tuple{circles, movements, segment};
+        },
+        [] (const CirclePacket<N>& c, const VectorPacket<N>& m, const Segment& s) {
+            return collide(c, m, s);
+        });
+}
+
+void benchIntersect(Suite& suite)
+{
+    Generator& gen = suite.generator();
+
+    suite.measureHits(
+        "intersect(Point, Circle)",
+        [&] { return std::tuple{gen.point(), gen.circle()}; },
+        [] (const Point& p, const Circle& c) { return intersect(p, c); });
+    suite.measureHits(
+        "intersect(Circle, Circle)",
+        [&] { return std::tuple{gen.circle(), gen.circle()}; },
+        [] (const Circle& a, const Circle& b) { return intersect(a, b); });
+    suite.measureHits(
+        "intersect(Point, AxisAlignedRect)",
+        [&] { return std::tuple{gen.point(), gen.rect()}; },
+        [] (const Point& p, const AxisAlignedRect& r) { return intersect(p, r); });
+    suite.measureHits(
+        "intersect(AxisAlignedRect, Point)",
+        [&] { return std::tuple{gen.rect(), gen.point()}; },
+        [] (const AxisAlignedRect& r, const Point& p) { return intersect(r, p); });
+    suite.measureHits(
+        "intersect(AxisAlignedRect, AxisAlignedRect)",
+        [&] { return std::tuple{gen.rect(), gen.rect()}; },
+        [] (const AxisAlignedRect& a, AxisAlignedRect b) { return intersect(a, b); });
+    suite.measureHits(
+        "intersect(Circle, AxisAlignedRect)",
+        [&] { return std::tuple{gen.circle(), gen.rect()}; },
+        [] (const Circle& c, const AxisAlignedRect& r) { return intersect(c, r); });
+    suite.measureHits(
+        "intersect(Circle, Line)",
+        [&] { return std::tuple{gen.circle(), gen.line()}; },
+        [] (const Circle& c, const Line& l) { return intersect(c, l); });
+    suite.measureHits(
+        "intersect(Line, Circle)",
+        [&] { return std::tuple{gen.line(), gen.circle()}; },
+        [] (const Line& l, const Circle& c) { return intersect(l, c); });
+    suite.measureHits(
+        "intersect(Line, AxisAlignedRect)",
+        [&] { return std::tuple{gen.line(), gen.rect()}; },
+        [] (const Line& l, const AxisAlignedRect& r) { return intersect(l, r); });
+    suite.measureHits(
+        "intersect(AxisAlignedRect, Line)",
+        [&] { return std::tuple{gen.rect(), gen.line()}; },
+        [] (const AxisAlignedRect& r, const Line& l) { return intersect(r, l); });
+}
+
+void benchIntersection(Suite& suite)
+{
+    Generator& gen = suite.generator();
+
+    // As in benchCollide, half of the pairs are parallel so that misses exist.
+    suite.measureHits(
+        "intersectionPoint(Line, Line)",
+        [&] {
+            Line first = gen.line();
+            Line second = gen.chance(0.5) ? Line{gen.point(), first.direction()} : gen.line();
+            return std::tuple{first, second};
+        },
+        [] (const Line& a, const Line& b) { return intersectionPoint(a, b); });
+    suite.measureHits(
+        "intersectionPoint(Line, Segment)",
+        [&] { return std::tuple{gen.line(), gen.segment()}; },
+        [] (const Line& l, const Segment& s) { return intersectionPoint(l, s); });
+    suite.measureHits(
+        "intersectionPoint(Ray, Line)",
+        [&] { return std::tuple{gen.ray(), gen.line()}; },
+        [] (const Ray& r, const Line& l) { return intersectionPoint(r, l); });
+    suite.measureHits(
+        "intersectionPoint(Ray, Segment)",
+        [&] { return std::tuple{gen.ray(), gen.segment()}; },
+        [] (const Ray& r, const Segment& s) { return intersectionPoint(r, s); });
+    suite.measureHits(
+        "intersectionSegment(Line, AxisAlignedRect)",
+        [&] { return std::tuple{gen.line(), gen.rect()}; },
+        [] (const Line& l, const AxisAlignedRect& r) { return intersectionSegment(l, r); });
+    suite.measureHits(
+        "intersectionSegment(Segment, AxisAlignedRect)",
+        [&] { return std::tuple{gen.segment(), gen.rect()}; },
+        [] (const Segment& s, const AxisAlignedRect& r) { return intersectionSegment(s, r); });
+
+    // hitTime returns infinity on a miss.
+    auto slab = [] (const SlabRay& ray, const AxisAlignedRect& r) {
+        return hitTime(ray, r, 1);
+    };
+    auto sweptSlab = [] (const SlabRay& ray, Scalar radius, const AxisAlignedRect& r) {
+        return hitTime(ray, radius, r, 1);
+    };
+    suite.measureHits(
+        "hitTime(SlabRay, AxisAlignedRect)",
+        [&] { return std::tuple{SlabRay{gen.point(), gen.vector()}, gen.rect()}; },
+        slab,
+        [&slab] (const auto& input) {
+            return std::apply(slab, input) != std::numeric_limits<Scalar>::infinity();
+        });
+    suite.measureHits(
+        "hitTime(SlabRay, Scalar, AxisAlignedRect)",
+        [&] { return std::tuple{SlabRay{gen.point(), gen.vector()}, gen.size(), gen.rect()}; },
+        sweptSlab,
+        [&sweptSlab] (const auto& input) {
+            return std::apply(sweptSlab, input) != std::numeric_limits<Scalar>::infinity();
+        });
+}
+
+template <size_t N>
+void benchIntersectionPacket(Suite& suite)
+{
+    Generator& gen = suite.generator();
+
+    suite.measurePackets<N>(
+        "intersectionPoint(RayPacket<" + std::to_string(N) + ">, Segment)",
+        [&gen] (HitMask wanted) {
+            Segment segment = gen.segment();
+            auto rays = RayPacket<N>{};
+            for (size_t lane = 0; lane < N; lane++) {
+                auto [origin, direction] = retry([&] {
+                    Point o = gen.point();
+                    Vector d = gen.vector();
+                    bool hit = intersectionPoint(Ray{o, d}, segment).has_value();
+                    return hit == laneHit(wanted, lane) ?
+                        std::optional{std::pair{o, d}} : std::nullopt;
+                });
+                rays.set(lane, origin, direction);
+            }
+            return std::tuple{rays, segment};
+        },
+        [] (const RayPacket<N>& r, const Segment& s) { return intersectionPoint(r, s); });
+}
+
+void benchDistance(Suite& suite)
+{
+    Generator& gen = suite.generator();
+
+    suite.measure(
+        "distance(Point, Point)",
+        [&] { return std::tuple{gen.point(), gen.point()}; },
+        [] (const Point& a, const Point& b) { return distance(a, b); });
+    suite.measure(
+        "distance(Point, Circle)",
+        [&] { return std::tuple{gen.point(), gen.circle()}; },
+        [] (const Point& p, const Circle& c) { return distance(p, c); });
+    suite.measure(
+        "distance(Circle, Point)",
+        [&] { return std::tuple{gen.circle(), gen.point()}; },
+        [] (const Circle& c, const Point& p) { return distance(c, p); });
+    suite.measure(
+        "distance(Point, Line)",
+        [&] { return std::tuple{gen.point(), gen.line()}; },
+        [] (const Point& p, const Line& l) { return distance(p, l); });
+    suite.measure(
+        "distance(Line, Point)",
+        [&] { return std::tuple{gen.line(), gen.point()}; },
+        [] (const Line& l, const Point& p) { return distance(l, p); });
+    suite.measure(
+        "distance(Line, Circle)",
+        [&] { return std::tuple{gen.line(), gen.circle()}; },
+        [] (const Line& l, const Circle& c) { return distance(l, c); });
+    suite.measure(
+        "distance(Circle, Line)",
+        [&] { return std::tuple{gen.circle(), gen.line()}; },
+        [] (const Circle& c, const Line& l) { return distance(c, l); });
+    suite.measure(
+        "distance(Line, AxisAlignedRect)",
+        [&] { return std::tuple{gen.line(), gen.rect()}; },
+        [] (const Line& l, AxisAlignedRect r) { return distance(l, r); });
+    suite.measure(
+        "signedDistance(Point, AxisAlignedRect)",
+        [&] { return std::tuple{gen.point(), gen.rect()}; },
+        [] (const Point& p, const AxisAlignedRect& r) { return signedDistance(p, r); });
+
+    // A level of 30 bricks in the generator's area; half a unit per cell.
+    auto grid = DistanceGrid{AxisAlignedRect{Point{0, 0}, 24, 24}, 0.5f, 4};
+    for (int i = 0; i < 30; i++) {
+        grid.add(gen.rect());
+    }
+
+    suite.measure(
+        "DistanceGrid::distance(Point)",
+        [&] { return std::tuple{gen.point()}; },
+        [&grid] (const Point& p) { return grid.distance(p); });
+    suite.measureHits(
+        "DistanceGrid::safeTravel(Circle, Vector)",
+        [&] { return std::tuple{gen.circle(), gen.vector()}; },
+        [&grid] (const Circle& c, const Vector& m) { return grid.safeTravel(c, m); },
+        [&grid] (const auto& input) {
+            const auto& [circle, movement] = input;
+            return grid.safeTravel(circle, movement) < movement.length();
+        });
+}
+
+} // namespace
+
+// Usage: geometry-bench [seed]. A hit is a query that reports a collision or
+// intersection; for DistanceGrid::safeTravel it is a blocked movement.
+// Results go to stdout as JSON, progress to stderr.
+int main(int argc, char* argv[])
+{
+    auto seed = static_cast<uint32_t>(argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1);
+
+    auto suite = Suite{seed};
+    benchVector(suite);
+    benchCollide(suite);
+    benchCollidePacket<4>(suite);
+    benchCollidePacket<8>(suite);
+    benchIntersect(suite);
+    benchIntersection(suite);
+    benchIntersectionPacket<4>(suite);
+    benchIntersectionPacket<8>(suite);
+    benchDistance(suite);
+
+    writeJson(std::cout, "geometry", suite.results());
+}
@@ -0,0 +1,30 @@
+#include "outline.hpp"
+
+namespace outline {
+
+Vector scaled(const Vector& vector, Scalar scalar)
+{
+    return vector * scalar;
+}
+
+Point translated(const Point& point, const Vector& vector)
+{
+    return point + vector;
+}
+
+Vector difference(const Point& lhs, const Point& rhs)
+{
+    return lhs - rhs;
+}
+
+Vector mirrored(const Vector& vector, const Norm& norm)
+{
+    return mirror(vector, norm);
+}
+
+Scalar length(const Vector& vector)
+{
+    return vector.length();
+}
+
+} // namespace outline
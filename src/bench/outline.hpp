@@ -0,0 +1,17 @@
+#pragma once
+
+#include "geometry.hpp"
+
+// Out-of-line copies of the operations in the ball step kernel, the way they
+// were defined in geometry.cpp before the core moved into geometry.hpp.
+// outline.cpp is its own translation unit, so these stay real calls unless
+// link-time optimization (BALLS_IPO) inlines them.
+namespace outline {
+
+Vector scaled(const Vector& vector, Scalar scalar);
+Point translated(const Point& point, const Vector& vector);
+Vector difference(const Point& lhs, const Point& rhs);
+Vector mirrored(const Vector& vector, const Norm& norm);
+Scalar length(const Vector& vector);
+
+} // namespace outline
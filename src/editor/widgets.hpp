@@ -159,8 +159,8 @@ public:
         const char* text,
         std::function<void()> action)
         : _outerRect{
-            .x = center.x - 50.f,
-            .y = center.y - 10.f,
+            .x = toFloat(center.x) - 50.f,
+            .y = toFloat(center.y) - 10.f,
             .w = 100.f,
             .h = 50.f,
         }
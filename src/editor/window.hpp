@@ -6,6 +6,8 @@
 #include "intersection.hpp"
 #include "sdl.hpp"
 
+#include <optional>
+#include <span>
 #include <vector>
 
 class Camera {
@@ -77,6 +79,11 @@ public:
         return intersectionSegment(line, _screenWorldRect);
     }
 
+    void clip(std::span<const Line> lines, std::span<std::optional<Segment>> out)
+    {
+        intersectionSegments(lines, _screenWorldRect, out);
+    }
+
 private:
     float _screenWidth = 0.f;
     float _screenHeight = 0.f;
@@ -163,10 +170,10 @@ private:
     SDL_FRect toSdl(const AxisAlignedRect& rect)
     {
         return SDL_FRect{
-            .x = rect.minX(),
-            .y = rect.minY(),
-            .w = rect.width,
-            .h = rect.height,
+            .x = toFloat(rect.minX()),
+            .y = toFloat(rect.minY()),
+            .w = toFloat(rect.width),
+            .h = toFloat(rect.height),
         };
     }
 
@@ -0,0 +1,387 @@
+#include "batch.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BATCH_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX2 instructions in functions marked for it;
+// MSVC accepts the intrinsics anywhere.
+#if defined(__GNUC__)
+#define BATCH_AVX2 __attribute__((target("avx2")))
+#else
+#define BATCH_AVX2
+#endif
+
+namespace {
+
+struct Binary {
+    const float* ax;
+    const float* ay;
+    const float* bx;
+    const float* by;
+    float* out;
+    size_t size;
+};
+
+struct Mirror {
+    float* xs;
+    float* ys;
+    const float* nxs;
+    const float* nys;
+    size_t size;
+};
+
+// Scalar kernels, also used for the tails of the SIMD ones. Each follows the
+// operation order of its counterpart in geometry.hpp.
+
+void dotScalar(const Binary& a, size_t i)
+{
+    for (; i < a.size; i++) {
+        a.out[i] = a.ax[i] * a.bx[i] + a.ay[i] * a.by[i];
+    }
+}
+
+void crossScalar(const Binary& a, size_t i)
+{
+    for (; i < a.size; i++) {
+        a.out[i] = a.ax[i] * a.by[i] - a.ay[i] * a.bx[i];
+    }
+}
+
+void squareDistanceScalar(const Binary& a, size_t i)
+{
+    for (; i < a.size; i++) {
+        float dx = a.bx[i] - a.ax[i];
+        float dy = a.by[i] - a.ay[i];
+        a.out[i] = dx * dx + dy * dy;
+    }
+}
+
+void normalizeScalar(float* xs, float* ys, size_t size, size_t i)
+{
+    for (; i < size; i++) {
+        float sqLength = xs[i] * xs[i] + ys[i] * ys[i];
+        if (sqLength > 0) {
+            float l = std::sqrt(sqLength);
+            xs[i] /= l;
+            ys[i] /= l;
+        }
+    }
+}
+
+void mirrorScalar(const Mirror& a, size_t i)
+{
+    for (; i < a.size; i++) {
+        float coordinate = a.xs[i] * a.nxs[i] + a.ys[i] * a.nys[i];
+        a.xs[i] -= 2 * a.nxs[i] * coordinate;
+        a.ys[i] -= 2 * a.nys[i] * coordinate;
+    }
+}
+
+#ifdef BATCH_X86
+
+// SSE2 is part of x86-64, so these need no target attribute.
+
+void dotSse2(const Binary& a)
+{
+    size_t i = 0;
+    for (; i + 4 <= a.size; i += 4) {
+        __m128 r = _mm_add_ps(
+            _mm_mul_ps(_mm_loadu_ps(a.ax + i), _mm_loadu_ps(a.bx + i)),
+            _mm_mul_ps(_mm_loadu_ps(a.ay + i), _mm_loadu_ps(a.by + i)));
+        _mm_storeu_ps(a.out + i, r);
+    }
+    dotScalar(a, i);
+}
+
+void crossSse2(const Binary& a)
+{
+    size_t i = 0;
+    for (; i + 4 <= a.size; i += 4) {
+        __m128 r = _mm_sub_ps(
+            _mm_mul_ps(_mm_loadu_ps(a.ax + i), _mm_loadu_ps(a.by + i)),
+            _mm_mul_ps(_mm_loadu_ps(a.ay + i), _mm_loadu_ps(a.bx + i)));
+        _mm_storeu_ps(a.out + i, r);
+    }
+    crossScalar(a, i);
+}
+
+void squareDistanceSse2(const Binary& a)
+{
+    size_t i = 0;
+    for (; i + 4 <= a.size; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(a.bx + i), _mm_loadu_ps(a.ax + i));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(a.by + i), _mm_loadu_ps(a.ay + i));
+        _mm_storeu_ps(
+            a.out + i, _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+    }
+    squareDistanceScalar(a, i);
+}
+
+void normalizeSse2(float* xs, float* ys, size_t size)
+{
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+        __m128 sqLength = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+        __m128 nonZero = _mm_cmpgt_ps(sqLength, _mm_setzero_ps());
+        __m128 l = _mm_sqrt_ps(sqLength);
+        __m128 nx = _mm_div_ps(x, l);
+        __m128 ny = _mm_div_ps(y, l);
+        _mm_storeu_ps(
+            xs + i, _mm_or_ps(_mm_and_ps(nonZero, nx), _mm_andnot_ps(nonZero, x)));
+        _mm_storeu_ps(
+            ys + i, _mm_or_ps(_mm_and_ps(nonZero, ny), _mm_andnot_ps(nonZero, y)));
+    }
+    normalizeScalar(xs, ys, size, i);
+}
+
+void mirrorSse2(const Mirror& a)
+{
+    const __m128 two = _mm_set1_ps(2.f);
+    size_t i = 0;
+    for (; i + 4 <= a.size; i += 4) {
+        __m128 x = _mm_loadu_ps(a.xs + i);
+        __m128 y = _mm_loadu_ps(a.ys + i);
+        __m128 nx = _mm_loadu_ps(a.nxs + i);
+        __m128 ny = _mm_loadu_ps(a.nys + i);
+        __m128 coordinate = _mm_add_ps(_mm_mul_ps(x, nx), _mm_mul_ps(y, ny));
+        x = _mm_sub_ps(x, _mm_mul_ps(_mm_mul_ps(two, nx), coordinate));
+        y = _mm_sub_ps(y, _mm_mul_ps(_mm_mul_ps(two, ny), coordinate));
+        _mm_storeu_ps(a.xs + i, x);
+        _mm_storeu_ps(a.ys + i, y);
+    }
+    mirrorScalar(a, i);
+}
+
+BATCH_AVX2 void dotAvx2(const Binary& a)
+{
+    size_t i = 0;
+    for (; i + 8 <= a.size; i += 8) {
+        __m256 r = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(a.ax + i), _mm256_loadu_ps(a.bx + i)),
+            _mm256_mul_ps(_mm256_loadu_ps(a.ay + i), _mm256_loadu_ps(a.by + i)));
+        _mm256_storeu_ps(a.out + i, r);
+    }
+    dotScalar(a, i);
+}
+
+BATCH_AVX2 void crossAvx2(const Binary& a)
+{
+    size_t i = 0;
+    for (; i + 8 <= a.size; i += 8) {
+        __m256 r = _mm256_sub_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(a.ax + i), _mm256_loadu_ps(a.by + i)),
+            _mm256_mul_ps(_mm256_loadu_ps(a.ay + i), _mm256_loadu_ps(a.bx + i)));
+        _mm256_storeu_ps(a.out + i, r);
+    }
+    crossScalar(a, i);
+}
+
+BATCH_AVX2 void squareDistanceAvx2(const Binary& a)
+{
+    size_t i = 0;
+    for (; i + 8 <= a.size; i += 8) {
+        __m256 dx = _mm256_sub_ps(
+            _mm256_loadu_ps(a.bx + i), _mm256_loadu_ps(a.ax + i));
+        __m256 dy = _mm256_sub_ps(
+            _mm256_loadu_ps(a.by + i), _mm256_loadu_ps(a.ay + i));
+        _mm256_storeu_ps(
+            a.out + i,
+            _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+    }
+    squareDistanceScalar(a, i);
+}
+
+BATCH_AVX2 void normalizeAvx2(float* xs, float* ys, size_t size)
+{
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256 sqLength = _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y));
+        __m256 nonZero =
+            _mm256_cmp_ps(sqLength, _mm256_setzero_ps(), _CMP_GT_OQ);
+        __m256 l = _mm256_sqrt_ps(sqLength);
+        _mm256_storeu_ps(
+            xs + i, _mm256_blendv_ps(x, _mm256_div_ps(x, l), nonZero));
+        _mm256_storeu_ps(
+            ys + i, _mm256_blendv_ps(y, _mm256_div_ps(y, l), nonZero));
+    }
+    normalizeScalar(xs, ys, size, i);
+}
+
+BATCH_AVX2 void mirrorAvx2(const Mirror& a)
+{
+    const __m256 two = _mm256_set1_ps(2.f);
+    size_t i = 0;
+    for (; i + 8 <= a.size; i += 8) {
+        __m256 x = _mm256_loadu_ps(a.xs + i);
+        __m256 y = _mm256_loadu_ps(a.ys + i);
+        __m256 nx = _mm256_loadu_ps(a.nxs + i);
+        __m256 ny = _mm256_loadu_ps(a.nys + i);
+        __m256 coordinate =
+            _mm256_add_ps(_mm256_mul_ps(x, nx), _mm256_mul_ps(y, ny));
+        x = _mm256_sub_ps(x, _mm256_mul_ps(_mm256_mul_ps(two, nx), coordinate));
+        y = _mm256_sub_ps(y, _mm256_mul_ps(_mm256_mul_ps(two, ny), coordinate));
+        _mm256_storeu_ps(a.xs + i, x);
+        _mm256_storeu_ps(a.ys + i, y);
+    }
+    mirrorScalar(a, i);
+}
+
+bool cpuHasAvx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+BatchIsa bestIsa()
+{
+#ifdef BATCH_X86
+    return cpuHasAvx2() ? BatchIsa::Avx2 : BatchIsa::Sse2;
+#else
+    return BatchIsa::Scalar;
+#endif
+}
+
+// Atomic so that setBatchIsa() may race with kernels running on other
+// threads; each call dispatches on whichever value it loads.
+std::atomic<BatchIsa>& currentIsa()
+{
+    static std::atomic<BatchIsa> isa = bestIsa();
+    return isa;
+}
+
+void checkSizes(size_t size, std::initializer_list<size_t> sizes)
+{
+    for (size_t other : sizes) {
+        if (other != size) {
+            throw std::invalid_argument{"batch spans differ in size"};
+        }
+    }
+}
+
+Binary binary(
+    std::span<const float> ax, std::span<const float> ay,
+    std::span<const float> bx, std::span<const float> by,
+    std::span<float> out)
+{
+    checkSizes(out.size(), {ax.size(), ay.size(), bx.size(), by.size()});
+    return Binary{ax.data(), ay.data(), bx.data(), by.data(), out.data(), out.size()};
+}
+
+} // namespace
+
+BatchIsa batchIsa()
+{
+    return currentIsa().load(std::memory_order_relaxed);
+}
+
+void setBatchIsa(BatchIsa isa)
+{
+    if (!batchIsaSupported(isa)) {
+        throw std::invalid_argument{"instruction set not supported"};
+    }
+    currentIsa().store(isa, std::memory_order_relaxed);
+}
+
+bool batchIsaSupported(BatchIsa isa)
+{
+    return isa <= bestIsa();
+}
+
+void dotMany(
+    std::span<const float> ax, std::span<const float> ay,
+    std::span<const float> bx, std::span<const float> by,
+    std::span<float> out)
+{
+    auto args = binary(ax, ay, bx, by, out);
+    switch (batchIsa()) {
+#ifdef BATCH_X86
+        case BatchIsa::Avx2: return dotAvx2(args);
+        case BatchIsa::Sse2: return dotSse2(args);
+#endif
+        default: return dotScalar(args, 0);
+    }
+}
+
+void crossMany(
+    std::span<const float> ax, std::span<const float> ay,
+    std::span<const float> bx, std::span<const float> by,
+    std::span<float> out)
+{
+    auto args = binary(ax, ay, bx, by, out);
+    switch (batchIsa()) {
+#ifdef BATCH_X86
+        case BatchIsa::Avx2: return crossAvx2(args);
+        case BatchIsa::Sse2: return crossSse2(args);
+#endif
+        default: return crossScalar(args, 0);
+    }
+}
+
+void normalizeMany(std::span<float> xs, std::span<float> ys)
+{
+    checkSizes(xs.size(), {ys.size()});
+    switch (batchIsa()) {
+#ifdef BATCH_X86
+        case BatchIsa::Avx2: return normalizeAvx2(xs.data(), ys.data(), xs.size());
+        case BatchIsa::Sse2: return normalizeSse2(xs.data(), ys.data(), xs.size());
+#endif
+        default: return normalizeScalar(xs.data(), ys.data(), xs.size(), 0);
+    }
+}
+
+void mirrorMany(
+    std::span<float> xs, std::span<float> ys,
+    std::span<const float> nxs, std::span<const float> nys)
+{
+    checkSizes(xs.size(), {ys.size(), nxs.size(), nys.size()});
+    auto args = Mirror{xs.data(), ys.data(), nxs.data(), nys.data(), xs.size()};
+    switch (batchIsa()) {
+#ifdef BATCH_X86
+        case BatchIsa::Avx2: return mirrorAvx2(args);
+        case BatchIsa::Sse2: return mirrorSse2(args);
+#endif
+        default: return mirrorScalar(args, 0);
+    }
+}
+
+void squareDistanceMany(
+    std::span<const float> ax, std::span<const float> ay,
+    std::span<const float> bx, std::span<const float> by,
+    std::span<float> out)
+{
+    auto args = binary(ax, ay, bx, by, out);
+    switch (batchIsa()) {
+#ifdef BATCH_X86
+        case BatchIsa::Avx2: return squareDistanceAvx2(args);
+        case BatchIsa::Sse2: return squareDistanceSse2(args);
+#endif
+        default: return squareDistanceScalar(args, 0);
+    }
+}
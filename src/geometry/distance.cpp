@@ -1,54 +1,246 @@
 #include "distance.hpp"
 
+#include "intersection.hpp"
+
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <ranges>
+#include <stdexcept>
 #include <vector>
 
-float distance(const Point& lhs, const Point& rhs)
+namespace {
+
+// Sphere tracing in DistanceGrid::safeTravel gives up after this many steps,
+// or once a step would be shorter than this fraction of a cell.
+constexpr int maxTraceSteps = 16;
+constexpr float minTraceStepCells = 0.25f;
+
+// Index of the cell containing offset, clamped to [0, count).
+size_t cellIndex(Scalar offset, Scalar cellSize, size_t count)
+{
+    float cell = std::floor(toFloat(offset / cellSize));
+    if (!(cell > 0)) {
+        return 0;
+    }
+    if (cell >= static_cast<float>(count)) {
+        return count - 1;
+    }
+    return static_cast<size_t>(cell);
+}
+
+size_t cellCount(Scalar length, Scalar cellSize)
+{
+    return std::max<size_t>(
+        1, static_cast<size_t>(std::ceil(toFloat(length / cellSize))));
+}
+
+} // namespace
+
+Scalar distance(const Point& lhs, const Point& rhs)
 {
     return (rhs - lhs).length();
 }
 
-float distance(const Point& point, const Circle& circle)
+Scalar distance(const Point& point, const Circle& circle)
 {
-    return std::max(0.f, distance(point, circle.center) - circle.radius);
+    return std::max(Scalar{0}, distance(point, circle.center) - circle.radius);
 }
 
-float distance(const Circle& circle, const Point& point)
+Scalar distance(const Circle& circle, const Point& point)
 {
     return distance(point, circle);
 }
 
-float distance(const Point& point, const Line& line)
+Scalar distance(const Point& point, const Line& line)
 {
-    return std::abs(dot(line.norm(), point - Point{0, 0}) - line.value());
+    using std::abs;
+    return abs(dot(line.norm(), point - Point{0, 0}) - line.value());
 }
 
-float distance(const Line& line, const Point& point)
+Scalar distance(const Line& line, const Point& point)
 {
     return distance(point, line);
 }
 
-float distance(const Line& line, const Circle& circle)
+Scalar distance(const Line& line, const Circle& circle)
 {
-    float circleCenterValue = dot(line.norm(), circle.center - Point{0, 0});
-    float valueDifference = std::abs(circleCenterValue - line.value());
-    return std::max(0.f, valueDifference - circle.radius);
+    Scalar circleCenterValue = dot(line.norm(), circle.center - Point{0, 0});
+    using std::abs;
+    Scalar valueDifference = abs(circleCenterValue - line.value());
+    return std::max(Scalar{0}, valueDifference - circle.radius);
 }
 
-float distance(const Circle& circle, const Line& line)
+Scalar distance(const Circle& circle, const Line& line)
 {
     return distance(line, circle);
 }
 
-float distance(const Line& line, AxisAlignedRect& rect)
+Scalar distance(const Line& line, AxisAlignedRect& rect)
 {
-    float minDistance = std::numeric_limits<float>::infinity();
+    Scalar minDistance = std::numeric_limits<Scalar>::infinity();
     for (const Point& point : rect.points()) {
-        if (float d = distance(line, point); d < minDistance) {
+        if (Scalar d = distance(line, point); d < minDistance) {
             minDistance = d;
         }
     }
     return minDistance;
 }
+
+Scalar signedDistance(const Point& point, const AxisAlignedRect& rect)
+{
+    using std::abs;
+    Scalar dx = abs(point.x - rect.center.x) - rect.width / 2;
+    Scalar dy = abs(point.y - rect.center.y) - rect.height / 2;
+    auto outside = Vector{std::max(dx, Scalar{0}), std::max(dy, Scalar{0})};
+    return outside.length() + std::min(std::max(dx, dy), Scalar{0});
+}
+
+DistanceGrid::DistanceGrid(
+        const AxisAlignedRect& bounds, Scalar cellSize, Scalar maxDistance)
+    : _bounds(bounds)
+    , _cellSize(cellSize)
+    , _maxDistance(maxDistance)
+{
+    if (!(cellSize > 0) || !(maxDistance > 0)) {
+        throw std::invalid_argument{"DistanceGrid: cell size and max distance must be positive"};
+    }
+    if (!(bounds.width > 0) || !(bounds.height > 0)) {
+        throw std::invalid_argument{"DistanceGrid: empty bounds"};
+    }
+
+    _columns = cellCount(bounds.width, cellSize);
+    _rows = cellCount(bounds.height, cellSize);
+    _samples.assign(_columns * _rows, maxDistance);
+}
+
+std::span<const AxisAlignedRect> DistanceGrid::rects() const
+{
+    return _rects;
+}
+
+void DistanceGrid::add(const AxisAlignedRect& rect)
+{
+    _rects.push_back(rect);
+    stamp(rect);
+}
+
+void DistanceGrid::remove(size_t index)
+{
+    if (index >= _rects.size()) {
+        throw std::out_of_range{"DistanceGrid::remove"};
+    }
+    AxisAlignedRect removed = _rects[index];
+    _rects.erase(_rects.begin() + static_cast<ptrdiff_t>(index));
+
+    // Only rects within maxDistance of one of the recomputed cell centers can
+    // lower its sample. The region is taken from the cells themselves: their
+    // centers reach up to half a cell past maxDistance from the removed rect,
+    // and further for rects clamped to the border of the grid.
+    CellRange cells = cellsNear(removed);
+    Point first = cellCenter(cells.firstColumn, cells.firstRow);
+    Point last = cellCenter(cells.lastColumn, cells.lastRow);
+    auto region = AxisAlignedRect{
+        Point{(first.x + last.x) / 2, (first.y + last.y) / 2},
+        last.x - first.x + 2 * _maxDistance,
+        last.y - first.y + 2 * _maxDistance,
+    };
+    auto nearby = std::vector<AxisAlignedRect>{};
+    for (const AxisAlignedRect& rect : _rects) {
+        if (intersect(rect, region)) {
+            nearby.push_back(rect);
+        }
+    }
+
+    for (size_t row = cells.firstRow; row <= cells.lastRow; row++) {
+        for (size_t column = cells.firstColumn; column <= cells.lastColumn; column++) {
+            Point center = cellCenter(column, row);
+            Scalar sample = _maxDistance;
+            for (const AxisAlignedRect& rect : nearby) {
+                sample = std::min(sample, signedDistance(center, rect));
+            }
+            _samples[row * _columns + column] = sample;
+        }
+    }
+}
+
+void DistanceGrid::assign(std::span<const AxisAlignedRect> rects)
+{
+    _rects.assign(rects.begin(), rects.end());
+    std::ranges::fill(_samples, _maxDistance);
+    for (const AxisAlignedRect& rect : _rects) {
+        stamp(rect);
+    }
+}
+
+// The sample bounds the signed distance at the cell center, which changes by
+// at most the distance moved, so subtracting that distance keeps the bound.
+Scalar DistanceGrid::distance(const Point& point) const
+{
+    size_t x = columnAt(point.x);
+    size_t y = rowAt(point.y);
+    return _samples[y * _columns + x] - (point - cellCenter(x, y)).length();
+}
+
+Scalar DistanceGrid::safeTravel(const Circle& circle, const Vector& movement) const
+{
+    Scalar length = movement.length();
+    if (length == 0) {
+        return 0;
+    }
+
+    Vector direction = movement / length;
+    Scalar minStep = _cellSize * minTraceStepCells;
+    Scalar travelled = 0;
+    for (int step = 0; step < maxTraceSteps; step++) {
+        Scalar clearance =
+            distance(circle.center + direction * travelled) - circle.radius;
+        if (clearance < minStep) {
+            break;
+        }
+        travelled += clearance;
+        if (travelled >= length) {
+            return length;
+        }
+    }
+    return travelled;
+}
+
+DistanceGrid::CellRange DistanceGrid::cellsNear(const AxisAlignedRect& rect) const
+{
+    return CellRange{
+        .firstColumn = columnAt(rect.minX() - _maxDistance),
+        .lastColumn = columnAt(rect.maxX() + _maxDistance),
+        .firstRow = rowAt(rect.minY() - _maxDistance),
+        .lastRow = rowAt(rect.maxY() + _maxDistance),
+    };
+}
+
+void DistanceGrid::stamp(const AxisAlignedRect& rect)
+{
+    CellRange cells = cellsNear(rect);
+    for (size_t row = cells.firstRow; row <= cells.lastRow; row++) {
+        for (size_t column = cells.firstColumn; column <= cells.lastColumn; column++) {
+            Scalar& sample = _samples[row * _columns + column];
+            sample = std::min(sample, signedDistance(cellCenter(column, row), rect));
+        }
+    }
+}
+
+Point DistanceGrid::cellCenter(size_t column, size_t row) const
+{
+    return Point{
+        _bounds.minX() + _cellSize * (static_cast<Scalar>(column) + Scalar{0.5f}),
+        _bounds.minY() + _cellSize * (static_cast<Scalar>(row) + Scalar{0.5f}),
+    };
+}
+
+size_t DistanceGrid::columnAt(Scalar x) const
+{
+    return cellIndex(x - _bounds.minX(), _cellSize, _columns);
+}
+
+size_t DistanceGrid::rowAt(Scalar y) const
+{
+    return cellIndex(y - _bounds.minY(), _cellSize, _rows);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <span>
+
+// Batch forms of the Vector and Point operations on struct-of-arrays float
+// spans: vector i is (xs[i], ys[i]). All spans of one call must have the same
+// size, otherwise std::invalid_argument is thrown. Results match the
+// one-at-a-time functions in geometry.hpp within float rounding; the SIMD
+// paths use the same operation order, so in practice they are bit-identical.
+
+// Instruction sets the kernels are compiled for. The best one the CPU
+// supports is picked on first use.
+enum class BatchIsa {
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+BatchIsa batchIsa();
+
+// Overrides the automatic choice, e.g. to compare paths. Throws
+// std::invalid_argument if the CPU or build does not support the set.
+void setBatchIsa(BatchIsa isa);
+
+bool batchIsaSupported(BatchIsa isa);
+
+// out[i] = dot(a[i], b[i])
+void dotMany(
+    std::span<const float> ax, std::span<const float> ay,
+    std::span<const float> bx, std::span<const float> by,
+    std::span<float> out);
+
+// out[i] = cross(a[i], b[i])
+void crossMany(
+    std::span<const float> ax, std::span<const float> ay,
+    std::span<const float> bx, std::span<const float> by,
+    std::span<float> out);
+
+// Vector::normalize on every vector; zero vectors are left unchanged.
+void normalizeMany(std::span<float> xs, std::span<float> ys);
+
+// v[i] = mirror(v[i], n[i]) for unit normals n.
+void mirrorMany(
+    std::span<float> xs, std::span<float> ys,
+    std::span<const float> nxs, std::span<const float> nys);
+
+// out[i] = squareDistance(a[i], b[i])
+void squareDistanceMany(
+    std::span<const float> ax, std::span<const float> ay,
+    std::span<const float> bx, std::span<const float> by,
+    std::span<float> out);
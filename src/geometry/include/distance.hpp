@@ -2,11 +2,79 @@
 
 #include "geometry.hpp"
 
-float distance(const Point& lhs, const Point& rhs);
-float distance(const Point& point, const Circle& circle);
-float distance(const Circle& circle, const Point& point);
-float distance(const Point& point, const Line& line);
-float distance(const Line& line, const Point& point);
-float distance(const Line& line, const Circle& circle);
-float distance(const Circle& circle, const Line& line);
-float distance(const Line& line, AxisAlignedRect& rect);
\ No newline at end of file
+#include <cstddef>
+#include <span>
+#include <vector>
+
+Scalar distance(const Point& lhs, const Point& rhs);
+Scalar distance(const Point& point, const Circle& circle);
+Scalar distance(const Circle& circle, const Point& point);
+Scalar distance(const Point& point, const Line& line);
+Scalar distance(const Line& line, const Point& point);
+Scalar distance(const Line& line, const Circle& circle);
+Scalar distance(const Circle& circle, const Line& line);
+Scalar distance(const Line& line, AxisAlignedRect& rect);
+
+// Distance to the rect's boundary, negative inside the rect.
+Scalar signedDistance(const Point& point, const AxisAlignedRect& rect);
+
+// Signed distance to a set of static rects, sampled at the cell centers of a
+// uniform grid over the given bounds. Samples are clamped to maxDistance, so
+// adding or removing a rect only recomputes the cells within maxDistance of
+// it; queries outside the bounds still work, they just get less precise.
+class DistanceGrid {
+public:
+    // Throws std::invalid_argument if cellSize or maxDistance is not
+    // positive, or the bounds are empty.
+    DistanceGrid(const AxisAlignedRect& bounds, Scalar cellSize, Scalar maxDistance);
+
+    std::span<const AxisAlignedRect> rects() const;
+
+    void add(const AxisAlignedRect& rect);
+
+    // Removes rects()[index], keeping the order of the others. Throws
+    // std::out_of_range for a bad index.
+    void remove(size_t index);
+
+    // Replaces all rects and rebuilds the whole grid.
+    void assign(std::span<const AxisAlignedRect> rects);
+
+    // O(1) lower bound of the distance to the nearest rect: for points
+    // outside all rects it is never more than the exact distance, and inside
+    // the bounds at most one cell diagonal less when a rect is within
+    // maxDistance. Values of 0 or below mean the point may be inside a rect.
+    Scalar distance(const Point& point) const;
+
+    // How far the circle can move along the movement without touching a
+    // rect, at most movement.length(). Sphere tracing on distance(): each
+    // step advances by the clearance, so the result is conservative and
+    // stops about a cell short of the first rect in the way. Exact collision
+    // is only needed when the result is less than the movement's length.
+    Scalar safeTravel(const Circle& circle, const Vector& movement) const;
+
+private:
+    struct CellRange {
+        size_t firstColumn;
+        size_t lastColumn;
+        size_t firstRow;
+        size_t lastRow;
+    };
+
+    // Cells whose centers lie within maxDistance of the rect.
+    CellRange cellsNear(const AxisAlignedRect& rect) const;
+
+    // Lowers the samples near the rect to its signed distance.
+    void stamp(const AxisAlignedRect& rect);
+
+    Point cellCenter(size_t column, size_t row) const;
+    size_t columnAt(Scalar x) const;
+    size_t rowAt(Scalar y) const;
+
+    AxisAlignedRect _bounds;
+    Scalar _cellSize;
+    Scalar _maxDistance;
+    size_t _columns = 0;
+    size_t _rows = 0;
+    std::vector<Scalar> _samples;
+    std::vector<AxisAlignedRect> _rects;
+};
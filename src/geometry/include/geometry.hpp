@@ -1,118 +1,338 @@
 #pragma once
 
 #include <array>
+#include <bit>
 #include <cmath>
+#include <cstdint>
 #include <ostream>
+#include <type_traits>
+
+#include "scalar.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
 
 class Norm;
 
+// Approximation of 1 / std::sqrt(x) for normal x > 0. The relative error is
+// below approxInverseSqrtError: 3e-7 on x86-64 (rsqrtss plus one Newton step)
+// and 5e-6 elsewhere (bit level estimate plus two Newton steps), against
+// about 6e-8 for the precise 1 / std::sqrt(x). normalization-test checks it.
+#if defined(__x86_64__) || defined(_M_X64)
+inline constexpr float approxInverseSqrtError = 3e-7f;
+#else
+inline constexpr float approxInverseSqrtError = 5e-6f;
+#endif
+
+inline float approxInverseSqrt(float x) noexcept
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+    return y * (1.5f - 0.5f * x * y * y);
+#else
+    float y = std::bit_cast<float>(0x5f375a86u - (std::bit_cast<uint32_t>(x) >> 1));
+    y = y * (1.5f - 0.5f * x * y * y);
+    return y * (1.5f - 0.5f * x * y * y);
+#endif
+}
+
+// The Vector and Point operations are defined inline below so that they
+// compile down to plain arithmetic at the call site, and constexpr so that
+// fixed geometry can be computed at compile time. Only the ones that need
+// sqrt are not constexpr. Coordinates are of type Scalar, see scalar.hpp.
 struct Vector {
-    Vector& operator+=(const Vector& other);
-    Vector& operator-=(const Vector& other);
-    Vector& operator*=(float scalar);
-    Vector& operator/=(float scalar);
+    constexpr Vector& operator+=(const Vector& other) noexcept
+    {
+        x += other.x;
+        y += other.y;
+        return *this;
+    }
+
+    constexpr Vector& operator-=(const Vector& other) noexcept
+    {
+        x -= other.x;
+        y -= other.y;
+        return *this;
+    }
+
+    constexpr Vector& operator*=(Scalar scalar) noexcept
+    {
+        x *= scalar;
+        y *= scalar;
+        return *this;
+    }
+
+    constexpr Vector& operator/=(Scalar scalar) noexcept
+    {
+        x /= scalar;
+        y /= scalar;
+        return *this;
+    }
 
-    [[nodiscard]] Norm normalized() const;
-    [[nodiscard]] Vector rotatedCw() const;
-    [[nodiscard]] Vector rotatedCcw() const;
+    [[nodiscard]] Norm normalized() const noexcept;
+
+    [[nodiscard]] constexpr Vector rotatedCw() const noexcept
+    {
+        return Vector{y, -x};
+    }
+
+    [[nodiscard]] constexpr Vector rotatedCcw() const noexcept
+    {
+        return Vector{-y, x};
+    }
+
+    // Saturates for long vectors under Q16.16, unlike length(); see Fixed.
+    constexpr Scalar squareLength() const noexcept
+    {
+        return x * x + y * y;
+    }
+
+    Scalar length() const noexcept
+    {
+        return hypotenuse(x, y);
+    }
+
+    void normalize() noexcept
+    {
+        Scalar l = hypotenuse(x, y);
+        if (l > 0) {
+            x /= l;
+            y /= l;
+        }
+    }
 
-    float squareLength() const;
-    float length() const;
-    void normalize();
+    // Fast tier of normalize(): the length afterwards is within
+    // approxInverseSqrtError + 2e-7 of 1, where normalize() keeps it within
+    // 2e-7. Both hold while the squared length is a normal float. Fixed-point
+    // scalars have no approximate tier and use normalize().
+    void normalizeApprox() noexcept
+    {
+        if constexpr (std::is_same_v<Scalar, float>) {
+            auto sqLength = static_cast<float>(x * x + y * y);
+            if (sqLength > 0) {
+                float inverseLength = approxInverseSqrt(sqLength);
+                x *= inverseLength;
+                y *= inverseLength;
+            }
+        } else {
+            normalize();
+        }
+    }
 
-    float x = 0.f;
-    float y = 0.f;
+    Scalar x = 0.f;
+    Scalar y = 0.f;
 };
 
-bool operator==(const Vector& lhs, const Vector& rhs);
-bool operator!=(const Vector& lhs, const Vector& rhs);
+constexpr bool operator==(const Vector& lhs, const Vector& rhs) noexcept
+{
+    return lhs.x == rhs.x && lhs.y == rhs.y;
+}
+
+constexpr bool operator!=(const Vector& lhs, const Vector& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
 
-Vector operator-(const Vector& vector);
-Vector operator+(Vector lhs, const Vector& rhs);
-Vector operator-(Vector lhs, const Vector& rhs);
-Vector operator*(Vector vector, float scalar);
-Vector operator*(float scalar, Vector vector);
-Vector operator/(Vector vector, float scalar);
+constexpr Vector operator-(const Vector& vector) noexcept
+{
+    return Vector{-vector.x, -vector.y};
+}
 
-float dot(const Vector& lhs, const Vector& rhs);
-float cross(const Vector& lhs, const Vector& rhs);
-bool leftTurn(const Vector& lhs, const Vector& rhs);
-bool rightTurn(const Vector& lhs, const Vector& rhs);
+constexpr Vector operator+(Vector lhs, const Vector& rhs) noexcept
+{
+    lhs += rhs;
+    return lhs;
+}
+
+constexpr Vector operator-(Vector lhs, const Vector& rhs) noexcept
+{
+    lhs -= rhs;
+    return lhs;
+}
+
+constexpr Vector operator*(Vector vector, Scalar scalar) noexcept
+{
+    vector *= scalar;
+    return vector;
+}
+
+constexpr Vector operator*(Scalar scalar, Vector vector) noexcept
+{
+    vector *= scalar;
+    return vector;
+}
+
+constexpr Vector operator/(Vector vector, Scalar scalar) noexcept
+{
+    vector /= scalar;
+    return vector;
+}
+
+constexpr Scalar dot(const Vector& lhs, const Vector& rhs) noexcept
+{
+    return lhs.x * rhs.x + lhs.y * rhs.y;
+}
+
+constexpr Scalar cross(const Vector& lhs, const Vector& rhs) noexcept
+{
+    return lhs.x * rhs.y - lhs.y * rhs.x;
+}
+
+constexpr bool leftTurn(const Vector& lhs, const Vector& rhs) noexcept
+{
+    return cross(lhs, rhs) > 0;
+}
+
+constexpr bool rightTurn(const Vector& lhs, const Vector& rhs) noexcept
+{
+    return cross(lhs, rhs) < 0;
+}
 
 class Norm {
 public:
-    explicit Norm(Vector vector)
-        : _vector(vector.normalized())
-    { }
+    explicit Norm(Vector vector) noexcept
+        : _vector(vector)
+    {
+        _vector.normalize();
+    }
+
+    // Trusts the caller that the vector already has unit length, e.g. an
+    // axis direction or a Norm computed earlier; nothing is checked.
+    static constexpr Norm fromUnit(const Vector& vector) noexcept
+    {
+        return Norm{vector.x, vector.y};
+    }
+
+    // Normalizes with Vector::normalizeApprox.
+    static Norm approximate(Vector vector) noexcept
+    {
+        vector.normalizeApprox();
+        return fromUnit(vector);
+    }
 
-    float x() const
+    constexpr Scalar x() const noexcept
     {
         return _vector.x;
     }
 
-    float y() const
+    constexpr Scalar y() const noexcept
     {
         return _vector.y;
     }
 
-    operator const Vector&() const
+    constexpr operator const Vector&() const noexcept
     {
         return _vector;
     }
 
-    [[nodiscard]] Norm rotatedCw() const;
-    [[nodiscard]] Norm rotatedCcw() const;
+    [[nodiscard]] constexpr Norm rotatedCw() const noexcept
+    {
+        return Norm{_vector.y, -_vector.x};
+    }
+
+    [[nodiscard]] constexpr Norm rotatedCcw() const noexcept
+    {
+        return Norm{-_vector.y, _vector.x};
+    }
 
 private:
-    Norm(float x, float y)
+    constexpr Norm(Scalar x, Scalar y) noexcept
         : _vector{x, y}
     { }
 
     Vector _vector;
 };
 
+inline Norm Vector::normalized() const noexcept
+{
+    return Norm{*this};
+}
+
 struct Point {
-    Point& operator+=(const Vector& vector);
-    Point& operator-=(const Vector& vector);
+    constexpr Point& operator+=(const Vector& vector) noexcept
+    {
+        x += vector.x;
+        y += vector.y;
+        return *this;
+    }
 
-    Vector asVector() const
+    constexpr Point& operator-=(const Vector& vector) noexcept
+    {
+        x -= vector.x;
+        y -= vector.y;
+        return *this;
+    }
+
+    constexpr Vector asVector() const noexcept
     {
         return Vector{x, y};
     }
 
     static const Point origin;
 
-    float x = 0.f;
-    float y = 0.f;
+    Scalar x = 0.f;
+    Scalar y = 0.f;
 };
 
-inline const Point Point::origin {0, 0};
+inline constexpr Point Point::origin {0, 0};
 
-bool operator==(const Point& lhs, const Point& rhs);
-bool operator!=(const Point& lhs, const Point& rhs);
+constexpr bool operator==(const Point& lhs, const Point& rhs) noexcept
+{
+    return lhs.x == rhs.x && lhs.y == rhs.y;
+}
 
-Point operator+(Point point, const Vector& vector);
-Point operator-(Point point, const Vector& vector);
-Vector operator-(const Point& lhs, const Point& rhs);
+constexpr bool operator!=(const Point& lhs, const Point& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+constexpr Point operator+(Point point, const Vector& vector) noexcept
+{
+    point += vector;
+    return point;
+}
+
+constexpr Point operator-(Point point, const Vector& vector) noexcept
+{
+    point -= vector;
+    return point;
+}
+
+constexpr Vector operator-(const Point& lhs, const Point& rhs) noexcept
+{
+    return Vector{lhs.x - rhs.x, lhs.y - rhs.y};
+}
 
 class Line {
 public:
-    Line(const Vector& norm, float value)
+    Line(const Vector& norm, Scalar value)
+        : _norm(norm)
+        , _value(value)
+    { }
+
+    // Overloads taking a Norm skip the normalization.
+    Line(const Norm& norm, Scalar value)
         : _norm(norm)
         , _value(value)
     { }
 
     Line(const Point& point, const Vector& direction)
         : _norm(normFromDirection(direction))
-        , _value(coordinate(point))
+        , _value(dot(_norm, point - Point::origin))
     { }
 
-    float coordinate(const Point& point) const
+    Line(const Point& point, const Norm& direction)
+        : _norm(direction.rotatedCw())
+        , _value(dot(_norm, point - Point::origin))
+    { }
+
+    Scalar coordinate(const Point& point) const
     {
         return dot(direction(), point - Point::origin);
     }
 
-    Point pointAtCoordinate(float coordinate) const
+    Point pointAtCoordinate(Scalar coordinate) const
     {
         return point() + direction() * coordinate;
     }
@@ -122,7 +342,7 @@ public:
         return _norm;
     }
 
-    float value() const
+    Scalar value() const
     {
         return _value;
     }
@@ -137,12 +357,12 @@ public:
         return directionFromNorm(_norm);
     }
 
-    float signedDistance(const Point& point) const
+    Scalar signedDistance(const Point& point) const
     {
         return dot(_norm, point - Point::origin);
     }
 
-    void moveTowards(const Point& point, float amount)
+    void moveTowards(const Point& point, Scalar amount)
     {
         if (dot(_norm, point.asVector()) >= _value) {
             _value += amount;
@@ -151,7 +371,7 @@ public:
         }
     }
 
-    [[nodiscard]] Line movedTowards(const Point& point, float amount) const
+    [[nodiscard]] Line movedTowards(const Point& point, Scalar amount) const
     {
         auto moved = *this;
         moved.moveTowards(point, amount);
@@ -170,7 +390,7 @@ private:
     }
 
     Norm _norm;
-    float _value;
+    Scalar _value;
 };
 
 class Ray {
@@ -180,6 +400,11 @@ public:
         , _start(_line.coordinate(point))
     { }
 
+    Ray(const Point& point, const Norm& direction)
+        : _line(point, direction)
+        , _start(_line.coordinate(point))
+    { }
+
     const Line& line() const
     {
         return _line;
@@ -192,7 +417,7 @@ public:
 
 private:
     Line _line;
-    float _start = 0.f;
+    Scalar _start = 0.f;
 };
 
 class Segment {
@@ -207,6 +432,14 @@ public:
         }
     }
 
+    // The direction must be the unit vector from the first to the second
+    // point.
+    Segment(const Point& firstPoint, const Point& secondPoint, const Norm& direction)
+        : _line(firstPoint, direction)
+        , _start(_line.coordinate(firstPoint))
+        , _end(_line.coordinate(secondPoint))
+    { }
+
     const Line& line() const
     {
         return _line;
@@ -227,12 +460,12 @@ public:
         return _line.pointAtCoordinate(_end);
     }
 
-    void moveTowards(const Point& point, float amount)
+    void moveTowards(const Point& point, Scalar amount)
     {
         _line.moveTowards(point, amount);
     }
 
-    [[nodiscard]] Segment movedTowards(const Point& point, float amount) const
+    [[nodiscard]] Segment movedTowards(const Point& point, Scalar amount) const
     {
         auto moved = *this;
         moved.moveTowards(point, amount);
@@ -241,29 +474,29 @@ public:
 
     bool containsProjection(const Point& point) const
     {
-        float pointCoordinate = _line.coordinate(point);
+        Scalar pointCoordinate = _line.coordinate(point);
         return pointCoordinate >= _start && pointCoordinate <= _end;
     }
 
 private:
     Line _line;
-    float _start = 0.f;
-    float _end = 0.f;
+    Scalar _start = 0.f;
+    Scalar _end = 0.f;
 };
 
 struct Circle {
     Point center;
-    float radius = 0.f;
+    Scalar radius = 0.f;
 };
 
 struct AxisAlignedRect {
-    std::array<Point, 4> points() const
+    constexpr std::array<Point, 4> points() const noexcept
     {
         return {
-            Point{center.x - width / 2, center.y - width / 2},
-            Point{center.x - width / 2, center.y + width / 2},
-            Point{center.x + width / 2, center.y + width / 2},
-            Point{center.x + width / 2, center.y - width / 2},
+            Point{minX(), minY()},
+            Point{minX(), maxY()},
+            Point{maxX(), maxY()},
+            Point{maxX(), minY()},
         };
     }
 
@@ -271,42 +504,51 @@ struct AxisAlignedRect {
     {
         auto ps = points();
         return {
-            Segment{ps[0], ps[1]},
-            Segment{ps[1], ps[2]},
-            Segment{ps[2], ps[3]},
-            Segment{ps[3], ps[0]},
+            Segment{ps[0], ps[1], Norm::fromUnit({0, 1})},
+            Segment{ps[1], ps[2], Norm::fromUnit({1, 0})},
+            Segment{ps[2], ps[3], Norm::fromUnit({0, -1})},
+            Segment{ps[3], ps[0], Norm::fromUnit({-1, 0})},
         };
     }
 
     bool containsPoint(const Point& point) const
     {
-        return std::abs(point.x - center.x) <= width / 2 &&
-            std::abs(point.y - center.y) <= height / 2;
+        using std::abs;
+        return abs(point.x - center.x) <= width / 2 &&
+            abs(point.y - center.y) <= height / 2;
     }
 
-    Point topLeft() const
+    constexpr Point topLeft() const noexcept
     {
         return Point(minX(), maxY());
     }
 
-    float minX() const { return center.x - width / 2; }
-    float maxX() const { return center.x + width / 2; }
-    float minY() const { return center.y - height / 2; }
-    float maxY() const { return center.y + height / 2; }
+    constexpr Scalar minX() const noexcept { return center.x - width / 2; }
+    constexpr Scalar maxX() const noexcept { return center.x + width / 2; }
+    constexpr Scalar minY() const noexcept { return center.y - height / 2; }
+    constexpr Scalar maxY() const noexcept { return center.y + height / 2; }
 
     Point center;
-    float width = 0.f;
-    float height = 0.f;
+    Scalar width = 0.f;
+    Scalar height = 0.f;
 };
 
 std::ostream& operator<<(std::ostream& output, const AxisAlignedRect& rect);
 
-inline float det(const Vector& a, const Vector& b) noexcept
+constexpr Scalar det(const Vector& a, const Vector& b) noexcept
 {
     return a.x * b.y - a.y * b.x;
 }
 
-float squareDistance(const Point& lhs, const Point& rhs);
-Vector mirror(const Vector& vector, const Norm& norm);
+constexpr Scalar squareDistance(const Point& lhs, const Point& rhs) noexcept
+{
+    return (rhs - lhs).squareLength();
+}
+
+constexpr Vector mirror(const Vector& vector, const Norm& norm) noexcept
+{
+    Scalar vectorCoordinate = dot(vector, norm);
+    return vector - 2 * norm * vectorCoordinate;
+}
 
 Point closestPoint(const Line& line, const Point& point);
\ No newline at end of file
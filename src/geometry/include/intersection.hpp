@@ -1,8 +1,11 @@
 #pragma once
 
 #include "geometry.hpp"
+#include "packet.hpp"
 
+#include <limits>
 #include <optional>
+#include <span>
 
 bool intersect(const Point& point, const Circle& circle);
 bool intersect(const Circle& lhs, const Circle& rhs);
@@ -20,4 +23,82 @@ std::optional<Point> intersectionPoint(const Line& line, const Segment& segment)
 std::optional<Point> intersectionPoint(const Ray& ray, const Line& line);
 std::optional<Point> intersectionPoint(const Ray& ray, const Segment& segment);
 
-std::optional<Segment> intersectionSegment(const Line& line, const AxisAlignedRect& rect);
\ No newline at end of file
+// Packet form of intersectionPoint(Ray, Segment). Lanes with a zero direction
+// or one parallel to the segment miss.
+template <size_t N>
+PointHits<N> intersectionPoint(const RayPacket<N>& rays, const Segment& segment);
+
+// Part of the line or segment inside the rect, computed without allocating.
+// The result keeps the input's direction.
+std::optional<Segment> intersectionSegment(const Line& line, const AxisAlignedRect& rect);
+std::optional<Segment> intersectionSegment(
+    const Segment& segment, const AxisAlignedRect& rect);
+
+// intersectionSegment for every input; out[i] belongs to the i-th input.
+// Throws std::invalid_argument if the sizes differ.
+void intersectionSegments(
+    std::span<const Line> lines,
+    const AxisAlignedRect& rect,
+    std::span<std::optional<Segment>> out);
+void intersectionSegments(
+    std::span<const Segment> segments,
+    const AxisAlignedRect& rect,
+    std::span<std::optional<Segment>> out);
+
+// Ray prepared for slab tests against axis-aligned rects: points on it are
+// origin + direction * t, and the reciprocal direction is computed once.
+// Passing a movement vector as the direction makes t = 1 the end of the
+// movement.
+struct SlabRay {
+    SlabRay(const Point& origin, const Vector& direction) noexcept
+        : origin(origin)
+        , inverseDirection{Scalar{1} / direction.x, Scalar{1} / direction.y}
+    { }
+
+    Point origin;
+    Vector inverseDirection;
+};
+
+// Range of t for which the ray's line is inside the rect; empty if
+// enter > exit. No branches: a zero direction component yields infinities,
+// and the NaN from a ray running exactly along an edge is dropped, so
+// grazing an edge counts as inside.
+struct SlabInterval {
+    Scalar enter = 0.f;
+    Scalar exit = 0.f;
+};
+
+SlabInterval slabInterval(const SlabRay& ray, const AxisAlignedRect& rect);
+
+// Smallest t in [0, maxTime] at which the ray is inside the rect, or
+// infinity on a miss (the largest value for fixed-point scalars, whose
+// numeric_limits::infinity() stands in for it). A ray starting inside the rect hits at 0.
+Scalar hitTime(
+    const SlabRay& ray,
+    const AxisAlignedRect& rect,
+    Scalar maxTime = std::numeric_limits<Scalar>::infinity());
+
+// Swept circle: the ray carries the circle's center and the rect is grown by
+// the radius on every side. This is conservative: near the rect's corners it
+// reports hits that the exact rounded shape would miss, so use it to reject
+// candidates before an exact collide().
+Scalar hitTime(
+    const SlabRay& ray,
+    Scalar radius,
+    const AxisAlignedRect& rect,
+    Scalar maxTime = std::numeric_limits<Scalar>::infinity());
+
+// hitTime for every rect; out[i] belongs to rects[i]. Throws
+// std::invalid_argument if the sizes differ.
+void hitTimes(
+    const SlabRay& ray,
+    std::span<const AxisAlignedRect> rects,
+    std::span<Scalar> out,
+    Scalar maxTime = std::numeric_limits<Scalar>::infinity());
+
+void hitTimes(
+    const SlabRay& ray,
+    Scalar radius,
+    std::span<const AxisAlignedRect> rects,
+    std::span<Scalar> out,
+    Scalar maxTime = std::numeric_limits<Scalar>::infinity());
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "geometry.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// Packets hold N independent queries in struct-of-arrays form; lane i is the
+// i-th query. Packet functions run the same straight-line code in every lane
+// and report the outcome in a HitMask instead of branching, so their lane
+// loops vectorize. They are instantiated for N = 4 and N = 8, and the
+// one-at-a-time functions stay the reference for their results.
+
+// Bit i is set if lane i hit.
+using HitMask = uint32_t;
+
+constexpr bool laneHit(HitMask mask, size_t lane) noexcept
+{
+    return (mask >> lane) & 1;
+}
+
+template <size_t N>
+struct VectorPacket {
+    static_assert(N > 0 && N <= 32);
+
+    constexpr Vector operator[](size_t lane) const noexcept
+    {
+        return Vector{x[lane], y[lane]};
+    }
+
+    constexpr void set(size_t lane, const Vector& vector) noexcept
+    {
+        x[lane] = vector.x;
+        y[lane] = vector.y;
+    }
+
+    std::array<Scalar, N> x {};
+    std::array<Scalar, N> y {};
+};
+
+template <size_t N>
+struct PointPacket {
+    static_assert(N > 0 && N <= 32);
+
+    constexpr Point operator[](size_t lane) const noexcept
+    {
+        return Point{x[lane], y[lane]};
+    }
+
+    constexpr void set(size_t lane, const Point& point) noexcept
+    {
+        x[lane] = point.x;
+        y[lane] = point.y;
+    }
+
+    std::array<Scalar, N> x {};
+    std::array<Scalar, N> y {};
+};
+
+template <size_t N>
+struct CirclePacket {
+    constexpr Circle operator[](size_t lane) const noexcept
+    {
+        return Circle{center[lane], radius[lane]};
+    }
+
+    constexpr void set(size_t lane, const Circle& circle) noexcept
+    {
+        center.set(lane, circle.center);
+        radius[lane] = circle.radius;
+    }
+
+    PointPacket<N> center;
+    std::array<Scalar, N> radius {};
+};
+
+// Rays origin + direction * t for t >= 0, as Ray{origin, direction}. The
+// direction need not be normalized.
+template <size_t N>
+struct RayPacket {
+    constexpr void set(size_t lane, const Point& point, const Vector& vector) noexcept
+    {
+        origin.set(lane, point);
+        direction.set(lane, vector);
+    }
+
+    PointPacket<N> origin;
+    VectorPacket<N> direction;
+};
+
+// Points of the lanes that hit; the other lanes hold unspecified values.
+template <size_t N>
+struct PointHits {
+    std::optional<Point> operator[](size_t lane) const
+    {
+        if (!laneHit(mask, lane)) {
+            return std::nullopt;
+        }
+        return points[lane];
+    }
+
+    PointPacket<N> points;
+    HitMask mask = 0;
+};
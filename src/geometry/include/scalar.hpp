@@ -0,0 +1,289 @@
+#pragma once
+
+#include <cmath>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+namespace detail {
+
+template <class T>
+struct WideUnsigned : std::make_unsigned<T> { };
+
+// In strict ISO mode __int128 is not an integral type for the standard
+// library, so its unsigned counterpart is spelled out here.
+#ifdef __SIZEOF_INT128__
+__extension__ typedef __int128 Int128;
+__extension__ typedef unsigned __int128 UInt128;
+
+template <>
+struct WideUnsigned<Int128> {
+    using type = UInt128;
+};
+#endif
+
+} // namespace detail
+
+// Signed fixed-point number: Rep holds the value times 2^FractionBits, and
+// Wide is an integer type with room for the product of two Reps.
+//
+// Every operation is integer arithmetic with fully specified rounding, so the
+// results are bit-identical on all compilers and CPUs:
+// - +, - and * saturate at the representable range, * rounds toward negative
+//   infinity;
+// - / rounds toward zero and saturates, division by zero gives the largest
+//   value of the dividend's sign (0 / 0 is 0);
+// - sqrt is the exact floor of the square root of the raw value, hypotenuse
+//   that of x * x + y * y summed in Wide, so it does not saturate early.
+// Products saturate like any other result: in Q16.16 a squared length, dot or
+// cross product of vectors longer than about 181 is clamped to 32767, and only
+// lengths and distances, which go through hypotenuse, cover the full range.
+// Converting from float or double rounds to nearest; the conversion is exact
+// IEEE arithmetic and therefore deterministic as well.
+template <std::signed_integral Rep, class Wide, int FractionBits>
+class Fixed {
+    static_assert(sizeof(Wide) >= 2 * sizeof(Rep));
+
+    static constexpr Wide one = Wide{1} << FractionBits;
+    static constexpr Wide maxRaw = std::numeric_limits<Rep>::max();
+    static constexpr Wide minRaw = std::numeric_limits<Rep>::min();
+
+public:
+    constexpr Fixed() noexcept = default;
+
+    template <std::integral T>
+    constexpr Fixed(T value) noexcept
+        : _raw(saturate(static_cast<Wide>(value) * one))
+    { }
+
+    template <std::floating_point T>
+    constexpr Fixed(T value) noexcept
+        : _raw(fromDouble(static_cast<double>(value)))
+    { }
+
+    static constexpr Fixed fromRaw(Rep raw) noexcept
+    {
+        auto fixed = Fixed{};
+        fixed._raw = raw;
+        return fixed;
+    }
+
+    constexpr Rep raw() const noexcept
+    {
+        return _raw;
+    }
+
+    constexpr explicit operator double() const noexcept
+    {
+        return static_cast<double>(_raw) / static_cast<double>(one);
+    }
+
+    constexpr explicit operator float() const noexcept
+    {
+        return static_cast<float>(static_cast<double>(*this));
+    }
+
+    constexpr Fixed& operator+=(Fixed other) noexcept
+    {
+        _raw = saturate(Wide{_raw} + other._raw);
+        return *this;
+    }
+
+    constexpr Fixed& operator-=(Fixed other) noexcept
+    {
+        _raw = saturate(Wide{_raw} - other._raw);
+        return *this;
+    }
+
+    constexpr Fixed& operator*=(Fixed other) noexcept
+    {
+        _raw = saturate((Wide{_raw} * other._raw) >> FractionBits);
+        return *this;
+    }
+
+    constexpr Fixed& operator/=(Fixed other) noexcept
+    {
+        if (other._raw == 0) {
+            _raw = _raw > 0 ? static_cast<Rep>(maxRaw) :
+                _raw < 0 ? static_cast<Rep>(minRaw) : 0;
+        } else {
+            _raw = saturate(Wide{_raw} * one / other._raw);
+        }
+        return *this;
+    }
+
+    friend constexpr Fixed operator+(Fixed lhs, Fixed rhs) noexcept
+    {
+        return lhs += rhs;
+    }
+
+    friend constexpr Fixed operator-(Fixed lhs, Fixed rhs) noexcept
+    {
+        return lhs -= rhs;
+    }
+
+    friend constexpr Fixed operator*(Fixed lhs, Fixed rhs) noexcept
+    {
+        return lhs *= rhs;
+    }
+
+    friend constexpr Fixed operator/(Fixed lhs, Fixed rhs) noexcept
+    {
+        return lhs /= rhs;
+    }
+
+    friend constexpr Fixed operator-(Fixed value) noexcept
+    {
+        return fromRaw(saturate(-Wide{value._raw}));
+    }
+
+    friend constexpr bool operator==(Fixed, Fixed) noexcept = default;
+    friend constexpr auto operator<=>(Fixed, Fixed) noexcept = default;
+
+    friend constexpr Fixed abs(Fixed value) noexcept
+    {
+        return value._raw < 0 ? -value : value;
+    }
+
+    // Floor of the exact square root; negative values give 0.
+    friend constexpr Fixed sqrt(Fixed value) noexcept
+    {
+        if (value._raw <= 0) {
+            return Fixed{};
+        }
+        using Unsigned = typename detail::WideUnsigned<Wide>::type;
+        auto root = isqrt(static_cast<Unsigned>(value._raw) << FractionBits);
+        return fromRaw(static_cast<Rep>(root));
+    }
+
+    friend constexpr Fixed hypotenuse(Fixed x, Fixed y) noexcept
+    {
+        using Unsigned = typename detail::WideUnsigned<Wide>::type;
+        auto square = [] (Rep raw) {
+            auto magnitude = static_cast<Unsigned>(raw < 0 ? -Wide{raw} : raw);
+            return magnitude * magnitude;
+        };
+        auto root = isqrt(square(x._raw) + square(y._raw));
+        return fromRaw(saturate(static_cast<Wide>(root)));
+    }
+
+    friend std::ostream& operator<<(std::ostream& output, Fixed value)
+    {
+        return output << static_cast<double>(value);
+    }
+
+private:
+    static constexpr Rep saturate(Wide value) noexcept
+    {
+        return static_cast<Rep>(
+            value > maxRaw ? maxRaw : value < minRaw ? minRaw : value);
+    }
+
+    static constexpr Rep fromDouble(double value) noexcept
+    {
+        double scaled = value * static_cast<double>(one);
+        if (!(scaled > static_cast<double>(minRaw))) {
+            return scaled != scaled ? 0 : static_cast<Rep>(minRaw);
+        }
+        if (scaled >= static_cast<double>(maxRaw)) {
+            return static_cast<Rep>(maxRaw);
+        }
+        return static_cast<Rep>(scaled + (scaled >= 0 ? 0.5 : -0.5));
+    }
+
+    // Digit-by-digit integer square root.
+    template <class Unsigned>
+    static constexpr Unsigned isqrt(Unsigned value) noexcept
+    {
+        Unsigned result = 0;
+        Unsigned bit = Unsigned{1} << (sizeof(Unsigned) * 8 - 2);
+        while (bit > value) {
+            bit >>= 2;
+        }
+        while (bit != 0) {
+            if (value >= result + bit) {
+                value -= result + bit;
+                result = (result >> 1) + bit;
+            } else {
+                result >>= 1;
+            }
+            bit >>= 2;
+        }
+        return result;
+    }
+
+    Rep _raw = 0;
+};
+
+using Fixed16 = Fixed<int32_t, int64_t, 16>;
+
+#ifdef __SIZEOF_INT128__
+using Fixed32 = Fixed<int64_t, detail::Int128, 32>;
+#endif
+
+template <std::signed_integral Rep, class Wide, int FractionBits>
+class std::numeric_limits<Fixed<Rep, Wide, FractionBits>> {
+    using Type = Fixed<Rep, Wide, FractionBits>;
+
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_exact = true;
+    static constexpr bool has_infinity = false;
+
+    static constexpr Type min() noexcept
+    {
+        return Type::fromRaw(1);
+    }
+
+    static constexpr Type lowest() noexcept
+    {
+        return Type::fromRaw(std::numeric_limits<Rep>::min());
+    }
+
+    static constexpr Type max() noexcept
+    {
+        return Type::fromRaw(std::numeric_limits<Rep>::max());
+    }
+
+    static constexpr Type epsilon() noexcept
+    {
+        return Type::fromRaw(1);
+    }
+
+    // Fixed point has no infinity; the largest value stands in for it, so
+    // code written against float's infinity keeps working.
+    static constexpr Type infinity() noexcept
+    {
+        return max();
+    }
+};
+
+// Scalar type of the geometry library, selected at build time with the
+// BALLS_SCALAR CMake option. Q16.16 only builds the library and the
+// benchmarks, since products of window coordinates saturate in it.
+#if defined(GEOMETRY_SCALAR_FIXED16)
+using Scalar = Fixed16;
+#elif defined(GEOMETRY_SCALAR_FIXED32)
+#ifndef __SIZEOF_INT128__
+#error "Q32.32 fixed point needs a compiler with 128-bit integers"
+#endif
+using Scalar = Fixed32;
+#else
+using Scalar = float;
+#endif
+
+// sqrt(x * x + y * y); see Fixed for the fixed-point version.
+inline float hypotenuse(float x, float y) noexcept
+{
+    return std::sqrt(x * x + y * y);
+}
+
+// For handing geometry to float APIs such as SDL.
+constexpr float toFloat(Scalar value) noexcept
+{
+    return static_cast<float>(value);
+}
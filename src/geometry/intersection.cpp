@@ -1,7 +1,48 @@
 #include "intersection.hpp"
 
 #include <algorithm>
-#include <vector>
+#include <stdexcept>
+
+namespace {
+
+constexpr Scalar infinity = std::numeric_limits<Scalar>::infinity();
+
+// A slab bound is NaN when the ray runs exactly along it (0 * infinity).
+// std::max(a, b) and std::min(a, b) return a when b is NaN, so with the
+// running bound as the first argument a NaN bound leaves it unchanged.
+SlabInterval slabInterval(
+    const SlabRay& ray, Scalar minX, Scalar maxX, Scalar minY, Scalar maxY)
+{
+    Scalar x1 = (minX - ray.origin.x) * ray.inverseDirection.x;
+    Scalar x2 = (maxX - ray.origin.x) * ray.inverseDirection.x;
+    Scalar y1 = (minY - ray.origin.y) * ray.inverseDirection.y;
+    Scalar y2 = (maxY - ray.origin.y) * ray.inverseDirection.y;
+
+    bool forwardX = ray.inverseDirection.x >= 0;
+    bool forwardY = ray.inverseDirection.y >= 0;
+
+    Scalar enter = std::max(-infinity, forwardX ? x1 : x2);
+    Scalar exit = std::min(infinity, forwardX ? x2 : x1);
+    enter = std::max(enter, forwardY ? y1 : y2);
+    exit = std::min(exit, forwardY ? y2 : y1);
+    return SlabInterval{enter, exit};
+}
+
+Scalar hitTime(SlabInterval interval, Scalar maxTime)
+{
+    Scalar enter = std::max(interval.enter, Scalar{0});
+    bool hit = enter <= interval.exit && enter <= maxTime;
+    return hit ? enter : infinity;
+}
+
+void checkSizes(std::span<const AxisAlignedRect> rects, std::span<Scalar> out)
+{
+    if (rects.size() != out.size()) {
+        throw std::invalid_argument{"hitTimes: size mismatch"};
+    }
+}
+
+} // namespace
 
 bool intersect(const Point& point, const Circle& circle)
 {
@@ -26,8 +67,9 @@ bool intersect(const AxisAlignedRect& rect, const Point& point)
 
 bool intersect(const AxisAlignedRect& lhs, AxisAlignedRect& rhs)
 {
-    return std::abs(rhs.center.x - lhs.center.x) <= (lhs.width + rhs.width) / 2 &&
-        std::abs(rhs.center.y - lhs.center.y) <= (lhs.height + rhs.height) / 2;
+    using std::abs;
+    return abs(rhs.center.x - lhs.center.x) <= (lhs.width + rhs.width) / 2 &&
+        abs(rhs.center.y - lhs.center.y) <= (lhs.height + rhs.height) / 2;
 }
 
 bool intersect(const Circle& circle, const AxisAlignedRect& rect)
@@ -36,19 +78,21 @@ bool intersect(const Circle& circle, const AxisAlignedRect& rect)
         return true;
     }
 
-    float dx = std::min(
-        std::abs(circle.center.x - rect.minX()),
-        std::abs(circle.center.y - rect.maxX()));
-    float dy = std::min(
-        std::abs(circle.center.y - rect.minY()),
-        std::abs(circle.center.y - rect.maxY()));
+    using std::abs;
+    Scalar dx = std::min(
+        abs(circle.center.x - rect.minX()),
+        abs(circle.center.y - rect.maxX()));
+    Scalar dy = std::min(
+        abs(circle.center.y - rect.minY()),
+        abs(circle.center.y - rect.maxY()));
     return (dx * dx + dy * dy) <= circle.radius * circle.radius;
 }
 
 bool intersect(const Circle& circle, const Line& line)
 {
-    float circleCenterValue = dot(line.norm(), circle.center - Point{0, 0});
-    return std::abs(circleCenterValue - line.value()) <= circle.radius;
+    Scalar circleCenterValue = dot(line.norm(), circle.center - Point{0, 0});
+    using std::abs;
+    return abs(circleCenterValue - line.value()) <= circle.radius;
 }
 
 bool intersect(const Line& line, const Circle& circle)
@@ -63,10 +107,10 @@ bool intersect(const Line& line, const AxisAlignedRect& rect)
     auto v3 = Vector{rect.maxX(), rect.maxY()};
     auto v4 = Vector{rect.maxX(), rect.minY()};
 
-    float r1 = dot(line.norm(), v1) - line.value();
-    float r2 = dot(line.norm(), v2) - line.value();
-    float r3 = dot(line.norm(), v3) - line.value();
-    float r4 = dot(line.norm(), v4) - line.value();
+    Scalar r1 = dot(line.norm(), v1) - line.value();
+    Scalar r2 = dot(line.norm(), v2) - line.value();
+    Scalar r3 = dot(line.norm(), v3) - line.value();
+    Scalar r4 = dot(line.norm(), v4) - line.value();
 
     return r1 * r3 <= 0 || r2 * r4 <= 0;
 }
@@ -78,14 +122,14 @@ bool intersect(const AxisAlignedRect& rect, const Line& line)
 
 std::optional<Point> intersectionPoint(const Line& lhs, const Line& rhs)
 {
-    float d = det(lhs.norm(), rhs.norm());
+    Scalar d = det(lhs.norm(), rhs.norm());
     if (d == 0) {
         return std::nullopt;
     }
 
     auto valueVector = Vector{lhs.value(), rhs.value()};
-    float dx = det(valueVector, Vector{lhs.norm().y(), rhs.norm().y()});
-    float dy = det(Vector{lhs.norm().x(), rhs.norm().x()}, valueVector);
+    Scalar dx = det(valueVector, Vector{lhs.norm().y(), rhs.norm().y()});
+    Scalar dy = det(Vector{lhs.norm().x(), rhs.norm().x()}, valueVector);
 
     return Point{dx / d, dy / d};
 }
@@ -117,23 +161,137 @@ std::optional<Point> intersectionPoint(const Ray& ray, const Segment& segment)
     return std::nullopt;
 }
 
+// Solves origin + direction * t = start + edge * u per lane; the ray hits for
+// t >= 0 and u in [0, 1]. Parallel lanes divide by 1 instead of 0 and are
+// masked out.
+template <size_t N>
+PointHits<N> intersectionPoint(const RayPacket<N>& rays, const Segment& segment)
+{
+    Point start = segment.start();
+    Vector edge = segment.end() - start;
+
+    auto hits = PointHits<N>{};
+    for (size_t i = 0; i < N; i++) {
+        Point origin = rays.origin[i];
+        Vector direction = rays.direction[i];
+        Vector toStart = start - origin;
+
+        Scalar denominator = cross(direction, edge);
+        bool parallel = denominator == 0;
+        Scalar divisor = parallel ? Scalar{1} : denominator;
+        Scalar t = cross(toStart, edge) / divisor;
+        Scalar u = cross(toStart, direction) / divisor;
+
+        bool hit = !parallel & (t >= 0) & (u >= 0) & (u <= 1);
+        hits.points.set(i, origin + direction * t);
+        hits.mask |= HitMask{hit} << i;
+    }
+    return hits;
+}
+
+template PointHits<4> intersectionPoint(const RayPacket<4>&, const Segment&);
+template PointHits<8> intersectionPoint(const RayPacket<8>&, const Segment&);
+
+// Liang-Barsky: clip the parameter range of the line against both slabs of
+// the rect and rebuild the segment from the surviving range.
 std::optional<Segment> intersectionSegment(const Line& line, const AxisAlignedRect& rect)
 {
-    auto points = std::vector<Point>{};
-    for (const auto& segment : rect.segments()) {
-        if (auto p = intersectionPoint(line, segment)) {
-            points.push_back(*p);
-        }
+    Point point = line.point();
+    Norm direction = line.direction();
+    auto interval = slabInterval(SlabRay{point, direction}, rect);
+    if (interval.enter > interval.exit) {
+        return std::nullopt;
     }
+    return Segment{
+        point + direction * interval.enter,
+        point + direction * interval.exit,
+        direction};
+}
 
-    if (points.size() < 2) {
+std::optional<Segment> intersectionSegment(
+    const Segment& segment, const AxisAlignedRect& rect)
+{
+    Point start = segment.start();
+    Vector movement = segment.end() - start;
+    auto interval = slabInterval(SlabRay{start, movement}, rect);
+    Scalar enter = std::max(interval.enter, Scalar{0});
+    Scalar exit = std::min(interval.exit, Scalar{1});
+    if (enter > exit) {
         return std::nullopt;
     }
+    return Segment{
+        start + movement * enter,
+        start + movement * exit,
+        segment.line().direction()};
+}
+
+void intersectionSegments(
+    std::span<const Line> lines,
+    const AxisAlignedRect& rect,
+    std::span<std::optional<Segment>> out)
+{
+    if (lines.size() != out.size()) {
+        throw std::invalid_argument{"intersectionSegments: size mismatch"};
+    }
+    for (size_t i = 0; i < lines.size(); i++) {
+        out[i] = intersectionSegment(lines[i], rect);
+    }
+}
+
+void intersectionSegments(
+    std::span<const Segment> segments,
+    const AxisAlignedRect& rect,
+    std::span<std::optional<Segment>> out)
+{
+    if (segments.size() != out.size()) {
+        throw std::invalid_argument{"intersectionSegments: size mismatch"};
+    }
+    for (size_t i = 0; i < segments.size(); i++) {
+        out[i] = intersectionSegment(segments[i], rect);
+    }
+}
+
+SlabInterval slabInterval(const SlabRay& ray, const AxisAlignedRect& rect)
+{
+    return slabInterval(ray, rect.minX(), rect.maxX(), rect.minY(), rect.maxY());
+}
+
+Scalar hitTime(const SlabRay& ray, const AxisAlignedRect& rect, Scalar maxTime)
+{
+    return hitTime(slabInterval(ray, rect), maxTime);
+}
+
+Scalar hitTime(
+    const SlabRay& ray, Scalar radius, const AxisAlignedRect& rect, Scalar maxTime)
+{
+    auto interval = slabInterval(
+        ray,
+        rect.minX() - radius, rect.maxX() + radius,
+        rect.minY() - radius, rect.maxY() + radius);
+    return hitTime(interval, maxTime);
+}
 
-    std::ranges::sort(
-        points, {},
-        [&line] (const Point& point) {
-            return line.coordinate(point);
-        });
-    return Segment{points.front(), points.back()};
+void hitTimes(
+    const SlabRay& ray,
+    std::span<const AxisAlignedRect> rects,
+    std::span<Scalar> out,
+    Scalar maxTime)
+{
+    checkSizes(rects, out);
+    for (size_t i = 0; i < rects.size(); i++) {
+        out[i] = hitTime(slabInterval(ray, rects[i]), maxTime);
+    }
+}
+
+void hitTimes(
+    const SlabRay& ray,
+    Scalar radius,
+    std::span<const AxisAlignedRect> rects,
+    std::span<Scalar> out,
+    Scalar maxTime)
+{
+    checkSizes(rects, out);
+    for (size_t i = 0; i < rects.size(); i++) {
+        out[i] = hitTime(ray, radius, rects[i], maxTime);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "batch.hpp"
+#include "check.hpp"
+#include "geometry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// The references round every intermediate result when Scalar is fixed point,
+// so only float builds can expect the bit-identical results batch.hpp
+// promises.
+constexpr float tolerance = std::is_same_v<Scalar, float> ? 0.f : 1e-3f;
+
+struct Inputs {
+    std::vector<float> ax;
+    std::vector<float> ay;
+    std::vector<float> bx;
+    std::vector<float> by;
+};
+
+// Vector b[i] is a unit normal so that mirrorMany can take it; a[0] is the
+// zero vector that normalizeMany must leave alone.
+Inputs makeInputs(size_t size)
+{
+    auto rng = std::mt19937{static_cast<unsigned>(size)};
+    auto coordinate = std::uniform_real_distribution<float>{-10.f, 10.f};
+    auto inputs = Inputs{};
+    for (size_t i = 0; i < size; i++) {
+        inputs.ax.push_back(i == 0 ? 0.f : coordinate(rng));
+        inputs.ay.push_back(i == 0 ? 0.f : coordinate(rng));
+        float x = coordinate(rng);
+        float y = coordinate(rng) + 20.f;
+        float length = std::sqrt(x * x + y * y);
+        inputs.bx.push_back(x / length);
+        inputs.by.push_back(y / length);
+    }
+    return inputs;
+}
+
+bool matches(float actual, float expected)
+{
+    return std::abs(actual - expected) <= tolerance * std::max(1.f, std::abs(expected));
+}
+
+void checkAll(
+    std::span<const float> actual,
+    std::span<const float> expected,
+    const std::string& what)
+{
+    size_t mismatches = 0;
+    for (size_t i = 0; i < actual.size(); i++) {
+        mismatches += !matches(actual[i], expected[i]);
+    }
+    check(mismatches == 0, what + " differs from geometry.hpp");
+}
+
+void kernelsMatchScalarOps(size_t size, const std::string& isa)
+{
+    Inputs in = makeInputs(size);
+    auto a = [&in] (size_t i) { return Vector{in.ax[i], in.ay[i]}; };
+    auto b = [&in] (size_t i) { return Vector{in.bx[i], in.by[i]}; };
+
+    auto out = std::vector<float>(size);
+    auto expected = std::vector<float>(size);
+
+    dotMany(in.ax, in.ay, in.bx, in.by, out);
+    for (size_t i = 0; i < size; i++) {
+        expected[i] = toFloat(dot(a(i), b(i)));
+    }
+    checkAll(out, expected, isa + " dotMany");
+
+    crossMany(in.ax, in.ay, in.bx, in.by, out);
+    for (size_t i = 0; i < size; i++) {
+        expected[i] = toFloat(cross(a(i), b(i)));
+    }
+    checkAll(out, expected, isa + " crossMany");
+
+    squareDistanceMany(in.ax, in.ay, in.bx, in.by, out);
+    for (size_t i = 0; i < size; i++) {
+        expected[i] = toFloat(squareDistance(
+            Point{in.ax[i], in.ay[i]}, Point{in.bx[i], in.by[i]}));
+    }
+    checkAll(out, expected, isa + " squareDistanceMany");
+
+    auto xs = in.ax;
+    auto ys = in.ay;
+    auto expectedYs = std::vector<float>(size);
+    normalizeMany(xs, ys);
+    for (size_t i = 0; i < size; i++) {
+        Vector v = a(i);
+        v.normalize();
+        expected[i] = toFloat(v.x);
+        expectedYs[i] = toFloat(v.y);
+    }
+    checkAll(xs, expected, isa + " normalizeMany x");
+    checkAll(ys, expectedYs, isa + " normalizeMany y");
+
+    xs = in.ax;
+    ys = in.ay;
+    mirrorMany(xs, ys, in.bx, in.by);
+    for (size_t i = 0; i < size; i++) {
+        Vector v = mirror(a(i), Norm::fromUnit(b(i)));
+        expected[i] = toFloat(v.x);
+        expectedYs[i] = toFloat(v.y);
+    }
+    checkAll(xs, expected, isa + " mirrorMany x");
+    checkAll(ys, expectedYs, isa + " mirrorMany y");
+}
+
+// Every size up to a few SIMD widths, so that each kernel runs with and
+// without a vector body and with every tail length.
+void everyIsaMatchesScalarOps()
+{
+    auto isas = {
+        std::pair{BatchIsa::Scalar, std::string{"scalar"}},
+        std::pair{BatchIsa::Sse2, std::string{"SSE2"}},
+        std::pair{BatchIsa::Avx2, std::string{"AVX2"}},
+    };
+    BatchIsa original = batchIsa();
+    for (const auto& [isa, name] : isas) {
+        if (!batchIsaSupported(isa)) {
+            continue;
+        }
+        setBatchIsa(isa);
+        for (size_t size = 0; size <= 40; size++) {
+            kernelsMatchScalarOps(size, name);
+        }
+    }
+    setBatchIsa(original);
+}
+
+} // namespace
+
+int main()
+{
+    everyIsaMatchesScalarOps();
+    return testResult();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <source_location>
+#include <string_view>
+
+// Minimal test support: check() reports a failed condition with its
+// location, and a test's main returns testResult() so that ctest sees the
+// failure.
+inline int& failureCount()
+{
+    static int count = 0;
+    return count;
+}
+
+inline bool check(
+    bool condition,
+    std::string_view what,
+    std::source_location location = std::source_location::current())
+{
+    if (!condition) {
+        std::cerr << location.file_name() << ":" << location.line() << ": "
+            << what << "\n";
+        failureCount()++;
+    }
+    return condition;
+}
+
+inline int testResult()
+{
+    return failureCount() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
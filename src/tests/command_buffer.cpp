@@ -0,0 +1,73 @@
+#include "check.hpp"
+#include "command_buffer.hpp"
+
+#include <stdexcept>
+
+namespace {
+
+struct Value {
+    int value = 0;
+};
+
+template <class F>
+bool throwsInvalidArgument(F&& f)
+{
+    try {
+        f();
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+void pendingEntitiesResolve()
+{
+    auto ecs = ECS{};
+    auto buffer = CommandBuffer<ECS>{};
+    PendingEntity e = buffer.create();
+    buffer.add(e, Value{7});
+    buffer.flush(ecs);
+
+    check(ecs.entities<Value>().size() == 1, "the pending entity was not created");
+    check(ecs.components<Value>()[0].value == 7, "the component was not added");
+}
+
+void foreignHandlesThrow()
+{
+    auto first = CommandBuffer<ECS>{};
+    auto second = CommandBuffer<ECS>{};
+    PendingEntity e = first.create();
+
+    check(throwsInvalidArgument([&] { second.kill(e); }),
+        "a handle from another buffer was accepted");
+}
+
+// After a flush or clear the buffer hands out the same indices again, so an
+// old handle must not pass for the new entity with that index.
+void staleHandlesThrow()
+{
+    auto ecs = ECS{};
+    auto buffer = CommandBuffer<ECS>{};
+    PendingEntity flushed = buffer.create();
+    buffer.flush(ecs);
+    buffer.create();
+    check(throwsInvalidArgument([&] { buffer.add(flushed, Value{1}); }),
+        "a handle from before the flush was accepted");
+
+    PendingEntity cleared = buffer.create();
+    buffer.clear();
+    buffer.create();
+    buffer.create();
+    check(throwsInvalidArgument([&] { buffer.remove<Value>(cleared); }),
+        "a handle from before the clear was accepted");
+}
+
+} // namespace
+
+int main()
+{
+    pendingEntitiesResolve();
+    foreignHandlesThrow();
+    staleHandlesThrow();
+    return testResult();
+}
@@ -0,0 +1,93 @@
+#include "check.hpp"
+#include "distance.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+// The world's grid: the 1024x768 window, 8 unit cells, a band of 64.
+DistanceGrid makeGrid()
+{
+    return DistanceGrid{AxisAlignedRect{Point{512, 384}, 1024, 768}, 8, 64};
+}
+
+// Removing rects one by one must leave the same samples as building the grid
+// from the remaining rects, which the queries at and between the cell centers
+// observe exactly.
+void removeMatchesRebuild()
+{
+    auto rng = std::mt19937{1};
+    auto coordinate = std::uniform_real_distribution<float>{-100.f, 1124.f};
+    auto size = std::uniform_real_distribution<float>{4.f, 80.f};
+
+    auto grid = makeGrid();
+    for (int i = 0; i < 120; i++) {
+        grid.add(AxisAlignedRect{
+            Point{coordinate(rng), coordinate(rng) * 0.75f}, size(rng), size(rng)});
+    }
+
+    auto query = std::uniform_real_distribution<float>{-50.f, 1074.f};
+    while (!grid.rects().empty()) {
+        grid.remove(rng() % grid.rects().size());
+
+        auto rebuilt = makeGrid();
+        rebuilt.assign(grid.rects());
+        size_t mismatches = 0;
+        for (int i = 0; i < 2000; i++) {
+            auto point = Point{query(rng), query(rng) * 0.75f};
+            mismatches += grid.distance(point) != rebuilt.distance(point);
+        }
+        for (int y = 4; y < 768; y += 8) {
+            for (int x = 4; x < 1024; x += 8) {
+                auto center = Point{static_cast<Scalar>(x), static_cast<Scalar>(y)};
+                mismatches += grid.distance(center) != rebuilt.distance(center);
+            }
+        }
+        if (!check(mismatches == 0, "remove() differs from a rebuild")) {
+            return;
+        }
+    }
+}
+
+// distance() never exceeds the exact distance to the nearest rect, up to
+// rounding.
+void distanceIsLowerBound()
+{
+    auto rng = std::mt19937{2};
+    auto coordinate = std::uniform_real_distribution<float>{0.f, 1024.f};
+    auto size = std::uniform_real_distribution<float>{4.f, 80.f};
+
+    auto grid = makeGrid();
+    for (int i = 0; i < 60; i++) {
+        grid.add(AxisAlignedRect{
+            Point{coordinate(rng), coordinate(rng) * 0.75f}, size(rng), size(rng)});
+    }
+    for (int i = 0; i < 30; i++) {
+        grid.remove(rng() % grid.rects().size());
+    }
+
+    Scalar tolerance = 0.001f;
+    size_t violations = 0;
+    for (int i = 0; i < 100'000; i++) {
+        auto point = Point{coordinate(rng), coordinate(rng) * 0.75f};
+        Scalar exact = std::numeric_limits<Scalar>::infinity();
+        for (const AxisAlignedRect& rect : grid.rects()) {
+            exact = std::min(exact, signedDistance(point, rect));
+        }
+        violations += exact > 0 && grid.distance(point) > exact + tolerance;
+    }
+    check(violations == 0, "distance() exceeds the exact distance");
+}
+
+} // namespace
+
+int main()
+{
+    removeMatchesRebuild();
+    distanceIsLowerBound();
+    return testResult();
+}
@@ -0,0 +1,102 @@
+#include "check.hpp"
+#include "ecs.hpp"
+
+#include <cstddef>
+#include <iterator>
+
+namespace {
+
+struct Value {
+    int value = 0;
+};
+
+struct Other {
+    int value = 0;
+};
+
+struct Tracked {
+    int value = 0;
+};
+
+} // namespace
+
+template <>
+struct ComponentTraits<Tracked> : DefaultComponentTraits {
+    static constexpr bool trackChanges = true;
+    static constexpr bool inPlaceDelete = true;
+};
+
+namespace {
+
+template <class Registry>
+void addingTwiceReplaces(Registry& ecs)
+{
+    Entity e = ecs.create();
+    ecs.add(e, Value{1});
+    ecs.add(e, Value{2});
+    ecs.add(e, Tracked{1});
+    ecs.add(e, Tracked{2});
+
+    check(ecs.template entities<Value>().size() == 1, "adding twice added a second row");
+    check(ecs.template component<Value>(e).value == 2, "adding twice did not replace the value");
+    check(ecs.template component<Tracked>(e).value == 2, "adding twice did not replace the tracked value");
+    check(std::ranges::distance(ecs.template changed<Tracked>()) == 1,
+        "the replaced component is not listed once");
+
+    ecs.kill(e);
+    check(ecs.template entities<Value>().empty(), "a row outlived its entity");
+}
+
+void ecsAddingTwiceReplaces()
+{
+    auto ecs = ECS{};
+    addingTwiceReplaces(ecs);
+}
+
+void staticEcsAddingTwiceReplaces()
+{
+    auto ecs = StaticECS<Value, Other, Tracked>{};
+    addingTwiceReplaces(ecs);
+}
+
+void groupAddingTwiceReplaces()
+{
+    auto ecs = ECS{};
+    auto& group = ecs.group<Value, Other>();
+    Entity e = ecs.create();
+    ecs.add(e, Value{1});
+    ecs.add(e, Other{1});
+    ecs.add(e, Value{2});
+
+    check(group.size() == 1, "adding twice grouped the entity twice");
+    check(ecs.component<Value>(e).value == 2, "adding twice did not replace the grouped value");
+}
+
+void archetypeAddingTwiceReplaces()
+{
+    auto ecs = ArchetypeECS{};
+    Entity e = ecs.create();
+    ecs.add(e, Value{1});
+    ecs.add(e, Value{2});
+
+    size_t count = 0;
+    ecs.view<const Value>().each([&count] (Entity, const Value&) { count++; });
+    check(count == 1, "adding twice added a second row");
+    check(ecs.component<Value>(e).value == 2, "adding twice did not replace the value");
+
+    ecs.kill(e);
+    count = 0;
+    ecs.view<const Value>().each([&count] (Entity, const Value&) { count++; });
+    check(count == 0, "a row outlived its entity");
+}
+
+} // namespace
+
+int main()
+{
+    ecsAddingTwiceReplaces();
+    staticEcsAddingTwiceReplaces();
+    groupAddingTwiceReplaces();
+    archetypeAddingTwiceReplaces();
+    return testResult();
+}
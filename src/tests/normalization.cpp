@@ -0,0 +1,79 @@
+#include "check.hpp"
+#include "geometry.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <type_traits>
+
+namespace {
+
+bool withinBound(const char* name, double error, double bound)
+{
+    return check(
+        error < bound,
+        std::string{name} + ": max error " + std::to_string(error) +
+            " exceeds " + std::to_string(bound));
+}
+
+// Every 97th normal float.
+void approxInverseSqrtWithinBound()
+{
+    double error = 0;
+    constexpr uint32_t maxNormal = 0x7f7fffff;
+    for (uint32_t bits = 0x00800000; bits <= maxNormal; bits += 97) {
+        auto x = std::bit_cast<float>(bits);
+        double exact = 1 / std::sqrt(static_cast<double>(x));
+        error = std::max(error, std::abs(approxInverseSqrt(x) / exact - 1));
+    }
+    withinBound("approxInverseSqrt", error, approxInverseSqrtError);
+}
+
+// Vectors with lengths from 2^-40 to 2^40.
+void normalizeWithinBounds()
+{
+    auto rng = std::mt19937{1};
+    auto component = std::uniform_real_distribution<float>{-1.f, 1.f};
+    auto lengthError = [] (const Vector& v) {
+        auto x = static_cast<double>(v.x);
+        auto y = static_cast<double>(v.y);
+        return std::abs(std::sqrt(x * x + y * y) - 1);
+    };
+    double preciseError = 0;
+    double approxError = 0;
+    for (size_t i = 0; i < 1'000'000; i++) {
+        float scale = std::ldexp(1.f, static_cast<int>(rng() % 80) - 40);
+        float x = component(rng);
+        float y = component(rng);
+        if (std::abs(x) < 0.5f && std::abs(y) < 0.5f) {
+            continue;
+        }
+        Vector v{x * scale, y * scale};
+        Vector precise = v;
+        precise.normalize();
+        preciseError = std::max(preciseError, lengthError(precise));
+        Vector approximate = v;
+        approximate.normalizeApprox();
+        approxError = std::max(approxError, lengthError(approximate));
+    }
+    withinBound("Vector::normalize", preciseError, 2e-7);
+    withinBound(
+        "Vector::normalizeApprox", approxError, approxInverseSqrtError + 2e-7);
+}
+
+} // namespace
+
+// Checks the error bounds documented in geometry.hpp. They are float
+// properties, so fixed-point builds have nothing to check.
+int main()
+{
+    if constexpr (std::is_same_v<Scalar, float>) {
+        approxInverseSqrtWithinBound();
+        normalizeWithinBounds();
+    }
+    return testResult();
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Sequence stored in fixed-size chunks. Growing never moves existing
+// elements, so references stay valid until the element itself is removed,
+// and there is no transient double allocation as with std::vector.
+template <class T, size_t ChunkSize = 1024>
+class ChunkedVector {
+    template <bool Const>
+    class BasicIterator {
+        using Container =
+            std::conditional_t<Const, const ChunkedVector, ChunkedVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const T&, T&>;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Container* container, difference_type index)
+            : _container(container)
+            , _index(index)
+        { }
+
+        operator BasicIterator<true>() const
+        {
+            return BasicIterator<true>{_container, _index};
+        }
+
+        reference operator*() const
+        {
+            return (*_container)[static_cast<size_t>(_index)];
+        }
+
+        pointer operator->() const
+        {
+            return &**this;
+        }
+
+        reference operator[](difference_type n) const
+        {
+            return *(*this + n);
+        }
+
+        BasicIterator& operator++()
+        {
+            ++_index;
+            return *this;
+        }
+
+        BasicIterator operator++(int)
+        {
+            auto copy = *this;
+            ++_index;
+            return copy;
+        }
+
+        BasicIterator& operator--()
+        {
+            --_index;
+            return *this;
+        }
+
+        BasicIterator operator--(int)
+        {
+            auto copy = *this;
+            --_index;
+            return copy;
+        }
+
+        BasicIterator& operator+=(difference_type n)
+        {
+            _index += n;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type n)
+        {
+            _index -= n;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type n)
+        {
+            return it += n;
+        }
+
+        friend BasicIterator operator+(difference_type n, BasicIterator it)
+        {
+            return it += n;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type n)
+        {
+            return it -= n;
+        }
+
+        friend difference_type operator-(
+            const BasicIterator& lhs, const BasicIterator& rhs)
+        {
+            return lhs._index - rhs._index;
+        }
+
+        friend bool operator==(
+            const BasicIterator& lhs, const BasicIterator& rhs)
+        {
+            return lhs._index == rhs._index;
+        }
+
+        friend auto operator<=>(
+            const BasicIterator& lhs, const BasicIterator& rhs)
+        {
+            return lhs._index <=> rhs._index;
+        }
+
+    private:
+        Container* _container = nullptr;
+        difference_type _index = 0;
+    };
+
+public:
+    using value_type = T;
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    static constexpr size_t chunkSize = ChunkSize;
+
+    ChunkedVector() = default;
+    ChunkedVector(const ChunkedVector&) = delete;
+    ChunkedVector& operator=(const ChunkedVector&) = delete;
+
+    ChunkedVector(ChunkedVector&& other) noexcept
+        : _chunks(std::move(other._chunks))
+        , _size(std::exchange(other._size, 0))
+    { }
+
+    ChunkedVector& operator=(ChunkedVector&& other) noexcept
+    {
+        if (this != &other) {
+            clear();
+            _chunks = std::move(other._chunks);
+            _size = std::exchange(other._size, 0);
+        }
+        return *this;
+    }
+
+    ~ChunkedVector()
+    {
+        clear();
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    size_t capacity() const
+    {
+        return _chunks.size() * ChunkSize;
+    }
+
+    T& operator[](size_t index)
+    {
+        return *slot(index);
+    }
+
+    const T& operator[](size_t index) const
+    {
+        return *slot(index);
+    }
+
+    T& at(size_t index)
+    {
+        if (index >= _size) {
+            throw std::out_of_range{"ChunkedVector::at"};
+        }
+        return *slot(index);
+    }
+
+    const T& at(size_t index) const
+    {
+        if (index >= _size) {
+            throw std::out_of_range{"ChunkedVector::at"};
+        }
+        return *slot(index);
+    }
+
+    T& back()
+    {
+        return *slot(_size - 1);
+    }
+
+    const T& back() const
+    {
+        return *slot(_size - 1);
+    }
+
+    iterator begin()
+    {
+        return iterator{this, 0};
+    }
+
+    iterator end()
+    {
+        return iterator{this, static_cast<std::ptrdiff_t>(_size)};
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator{this, 0};
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator{this, static_cast<std::ptrdiff_t>(_size)};
+    }
+
+    size_t chunkCount() const
+    {
+        return (_size + ChunkSize - 1) / ChunkSize;
+    }
+
+    // The elements stored in one chunk, for bulk processing.
+    std::span<T> chunk(size_t index)
+    {
+        return {slot(index * ChunkSize), std::min(ChunkSize, _size - index * ChunkSize)};
+    }
+
+    std::span<const T> chunk(size_t index) const
+    {
+        return {slot(index * ChunkSize), std::min(ChunkSize, _size - index * ChunkSize)};
+    }
+
+    void reserve(size_t size)
+    {
+        while (capacity() < size) {
+            _chunks.push_back(std::make_unique<Chunk>());
+        }
+    }
+
+    template <class... Args>
+    T& emplace_back(Args&&... args)
+    {
+        reserve(_size + 1);
+        T* ptr = new (raw(_size)) T(std::forward<Args>(args)...);
+        _size++;
+        return *ptr;
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back()
+    {
+        _size--;
+        std::destroy_at(slot(_size));
+    }
+
+    // Destroys all elements and releases the chunks.
+    void clear()
+    {
+        while (_size > 0) {
+            pop_back();
+        }
+        _chunks.clear();
+    }
+
+private:
+    struct Chunk {
+        alignas(T) std::byte bytes[sizeof(T) * ChunkSize];
+    };
+
+    void* raw(size_t index) const
+    {
+        return _chunks[index / ChunkSize]->bytes + index % ChunkSize * sizeof(T);
+    }
+
+    T* slot(size_t index) const
+    {
+        return std::launder(static_cast<T*>(raw(index)));
+    }
+
+    std::vector<std::unique_ptr<Chunk>> _chunks;
+    size_t _size = 0;
+};
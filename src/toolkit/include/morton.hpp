@@ -0,0 +1,38 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+// Interleaves the bits of x and y: bit i of x becomes bit 2i of the code, bit
+// i of y becomes bit 2i + 1. Sorting by the code walks the plane along a
+// Z-order curve, so points close in space tend to be close in the order.
+constexpr uint64_t mortonCode(uint32_t x, uint32_t y)
+{
+    auto spread = [] (uint64_t v) {
+        v = (v | (v << 16)) & 0x0000ffff0000ffff;
+        v = (v | (v << 8)) & 0x00ff00ff00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0f;
+        v = (v | (v << 2)) & 0x3333333333333333;
+        v = (v | (v << 1)) & 0x5555555555555555;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+// Morton code of the grid cell containing (x, y), for square cells of the
+// given size. Negative coordinates are supported; cells beyond the 32-bit
+// range are clamped, and NaN falls into the cell at the origin.
+inline uint64_t mortonKey(float x, float y, float cellSize)
+{
+    auto cell = [cellSize] (float v) {
+        constexpr double min = std::numeric_limits<int32_t>::min();
+        constexpr double max = std::numeric_limits<int32_t>::max();
+        double c = std::floor(double{v} / cellSize);
+        c = std::isnan(c) ? 0.0 : std::clamp(c, min, max);
+        return static_cast<uint32_t>(
+            static_cast<int64_t>(c) - std::numeric_limits<int32_t>::min());
+    };
+    return mortonCode(cell(x), cell(y));
+}
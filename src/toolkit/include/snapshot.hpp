@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using Snapshot = std::vector<std::byte>;
+
+// Appends raw object representations to a byte buffer. Only trivially
+// copyable types can be written, so everything is a plain memcpy.
+class SnapshotWriter {
+public:
+    template <class T>
+    requires std::is_trivially_copyable_v<T>
+    void write(const T& value)
+    {
+        writeBytes(std::as_bytes(std::span{&value, 1}));
+    }
+
+    // Writes the element count followed by the elements.
+    template <class T>
+    requires std::is_trivially_copyable_v<T>
+    void writeRange(std::span<const T> values)
+    {
+        write(values.size());
+        writeBytes(std::as_bytes(values));
+    }
+
+    void writeBytes(std::span<const std::byte> bytes)
+    {
+        _snapshot.insert(_snapshot.end(), bytes.begin(), bytes.end());
+    }
+
+    const Snapshot& snapshot() const &
+    {
+        return _snapshot;
+    }
+
+    Snapshot snapshot() &&
+    {
+        return std::move(_snapshot);
+    }
+
+private:
+    Snapshot _snapshot;
+};
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::span<const std::byte> snapshot)
+        : _snapshot(snapshot)
+    { }
+
+    template <class T>
+    requires std::is_trivially_copyable_v<T>
+    T read()
+    {
+        T value;
+        readBytes(std::as_writable_bytes(std::span{&value, 1}));
+        return value;
+    }
+
+    template <class T>
+    requires std::is_trivially_copyable_v<T>
+    void read(T& value)
+    {
+        readBytes(std::as_writable_bytes(std::span{&value, 1}));
+    }
+
+    // Reads a range written by SnapshotWriter::writeRange, replacing the
+    // contents of the vector.
+    template <class T>
+    requires std::is_trivially_copyable_v<T>
+    void readRange(std::vector<T>& values)
+    {
+        values.resize(read<size_t>());
+        readBytes(std::as_writable_bytes(std::span{values}));
+    }
+
+    void readBytes(std::span<std::byte> bytes)
+    {
+        if (bytes.size() > _snapshot.size() - _offset) {
+            throw std::out_of_range{"SnapshotReader: truncated snapshot"};
+        }
+        if (!bytes.empty()) {
+            std::memcpy(bytes.data(), _snapshot.data() + _offset, bytes.size());
+        }
+        _offset += bytes.size();
+    }
+
+    bool done() const
+    {
+        return _offset == _snapshot.size();
+    }
+
+private:
+    std::span<const std::byte> _snapshot;
+    size_t _offset = 0;
+};
+
+// Encodes the blocks of current that differ from base. Restoring from a delta
+// needs the same base snapshot it was made against.
+Snapshot makeDelta(
+    std::span<const std::byte> base, std::span<const std::byte> current);
+
+Snapshot applyDelta(
+    std::span<const std::byte> base, std::span<const std::byte> delta);
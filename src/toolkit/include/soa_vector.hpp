@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Element types SoaVector can split: trivially copyable aggregates made only
+// of float fields, e.g. struct Movement { Point position; Vector velocity; }.
+// The float-only part cannot be checked without reflection; size and
+// alignment are checked instead.
+template <class T>
+concept FloatFields =
+    std::is_trivially_copyable_v<T> &&
+    std::is_default_constructible_v<T> &&
+    sizeof(T) % sizeof(float) == 0 &&
+    alignof(T) == alignof(float);
+
+// Sequence stored as one float array per field ("lane"), in declaration
+// order: for Movement, lane 0 is position.x, lane 1 position.y, lane 2
+// velocity.x and lane 3 velocity.y. Loops over a lane are unit-stride and
+// vectorize without gathers.
+//
+// Elements are not addressable. operator[] returns a proxy that converts to
+// T and assigns from T, copying all lanes each time.
+template <FloatFields T>
+class SoaVector {
+    using Fields = std::array<float, sizeof(T) / sizeof(float)>;
+
+public:
+    static constexpr size_t laneCount = sizeof(T) / sizeof(float);
+
+    // Lane of the float field at the given byte offset, e.g.
+    // laneAt(offsetof(Movement, velocity) + offsetof(Vector, y)).
+    static constexpr size_t laneAt(size_t byteOffset)
+    {
+        return byteOffset / sizeof(float);
+    }
+
+    class Reference {
+    public:
+        Reference(SoaVector* vector, size_t index)
+            : _vector(vector)
+            , _index(index)
+        { }
+
+        Reference(const Reference&) = default;
+
+        // Assigns the element, not the proxy.
+        const Reference& operator=(const Reference& other) const
+        {
+            return *this = other.value();
+        }
+
+        const Reference& operator=(const T& value) const
+        {
+            auto fields = std::bit_cast<Fields>(value);
+            for (size_t lane = 0; lane < laneCount; lane++) {
+                _vector->_lanes[lane][_index] = fields[lane];
+            }
+            return *this;
+        }
+
+        operator T() const
+        {
+            return value();
+        }
+
+        T value() const
+        {
+            return std::as_const(*_vector)[_index];
+        }
+
+        float& lane(size_t lane) const
+        {
+            return _vector->_lanes[lane][_index];
+        }
+
+        friend void swap(Reference lhs, Reference rhs)
+        {
+            for (size_t lane = 0; lane < laneCount; lane++) {
+                std::swap(lhs.lane(lane), rhs.lane(lane));
+            }
+        }
+
+    private:
+        SoaVector* _vector;
+        size_t _index;
+    };
+
+    size_t size() const
+    {
+        return _lanes[0].size();
+    }
+
+    bool empty() const
+    {
+        return _lanes[0].empty();
+    }
+
+    T operator[](size_t index) const
+    {
+        auto fields = Fields{};
+        for (size_t lane = 0; lane < laneCount; lane++) {
+            fields[lane] = _lanes[lane][index];
+        }
+        return std::bit_cast<T>(fields);
+    }
+
+    Reference operator[](size_t index)
+    {
+        return Reference{this, index};
+    }
+
+    Reference back()
+    {
+        return (*this)[size() - 1];
+    }
+
+    std::span<const float> lane(size_t lane) const
+    {
+        return _lanes[lane];
+    }
+
+    std::span<float> lane(size_t lane)
+    {
+        return _lanes[lane];
+    }
+
+    void reserve(size_t size)
+    {
+        for (auto& lane : _lanes) {
+            lane.reserve(size);
+        }
+    }
+
+    void resize(size_t size)
+    {
+        for (auto& lane : _lanes) {
+            lane.resize(size);
+        }
+    }
+
+    template <class... Args>
+    Reference emplace_back(Args&&... args)
+    {
+        auto fields = std::bit_cast<Fields>(T(std::forward<Args>(args)...));
+        for (size_t lane = 0; lane < laneCount; lane++) {
+            _lanes[lane].push_back(fields[lane]);
+        }
+        return back();
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    void pop_back()
+    {
+        for (auto& lane : _lanes) {
+            lane.pop_back();
+        }
+    }
+
+    void clear()
+    {
+        for (auto& lane : _lanes) {
+            lane.clear();
+        }
+    }
+
+private:
+    std::array<std::vector<float>, laneCount> _lanes;
+};
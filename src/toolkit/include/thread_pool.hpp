@@ -0,0 +1,26 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount);
+
+    void submit(std::function<void()> task);
+    size_t size() const;
+
+private:
+    void work(std::stop_token stopToken);
+
+    std::mutex _mutex;
+    std::condition_variable_any _condition;
+    std::deque<std::function<void()>> _tasks;
+    std::vector<std::jthread> _threads;
+};
@@ -0,0 +1,72 @@
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+// Deltas are tracked at this granularity; a changed byte resends its block.
+constexpr size_t blockSize = 64;
+
+bool blockChanged(
+    std::span<const std::byte> base,
+    std::span<const std::byte> current,
+    size_t offset)
+{
+    size_t end = std::min(offset + blockSize, current.size());
+    if (end > base.size()) {
+        return true;
+    }
+    return std::memcmp(base.data() + offset, current.data() + offset, end - offset) != 0;
+}
+
+} // namespace
+
+// Layout: current size, then (offset, length, bytes) runs of changed blocks.
+Snapshot makeDelta(
+    std::span<const std::byte> base, std::span<const std::byte> current)
+{
+    auto writer = SnapshotWriter{};
+    writer.write<uint64_t>(current.size());
+
+    size_t offset = 0;
+    while (offset < current.size()) {
+        if (!blockChanged(base, current, offset)) {
+            offset += blockSize;
+            continue;
+        }
+
+        size_t runEnd = offset + blockSize;
+        while (runEnd < current.size() && blockChanged(base, current, runEnd)) {
+            runEnd += blockSize;
+        }
+        runEnd = std::min(runEnd, current.size());
+
+        writer.write<uint64_t>(offset);
+        writer.writeRange(current.subspan(offset, runEnd - offset));
+        offset = runEnd;
+    }
+
+    return std::move(writer).snapshot();
+}
+
+Snapshot applyDelta(
+    std::span<const std::byte> base, std::span<const std::byte> delta)
+{
+    auto reader = SnapshotReader{delta};
+    auto size = static_cast<size_t>(reader.read<uint64_t>());
+
+    auto snapshot = Snapshot(size);
+    std::copy_n(base.begin(), std::min(size, base.size()), snapshot.begin());
+
+    while (!reader.done()) {
+        auto offset = static_cast<size_t>(reader.read<uint64_t>());
+        auto length = reader.read<size_t>();
+        if (offset > size || length > size - offset) {
+            throw std::out_of_range{"applyDelta: run outside of snapshot"};
+        }
+        reader.readBytes(std::span{snapshot}.subspan(offset, length));
+    }
+
+    return snapshot;
+}
@@ -0,0 +1,42 @@
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    _threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        _threads.emplace_back([this] (std::stop_token stopToken) {
+            work(stopToken);
+        });
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        auto lock = std::scoped_lock{_mutex};
+        _tasks.push_back(std::move(task));
+    }
+    _condition.notify_one();
+}
+
+size_t ThreadPool::size() const
+{
+    return _threads.size();
+}
+
+void ThreadPool::work(std::stop_token stopToken)
+{
+    for (;;) {
+        auto task = std::function<void()>{};
+        {
+            auto lock = std::unique_lock{_mutex};
+            if (!_condition.wait(
+                    lock, stopToken, [this] { return !_tasks.empty(); })) {
+                return;
+            }
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        task();
+    }
+}